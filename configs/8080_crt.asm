@@ -3,6 +3,7 @@
     module i8080_crt0
 
     defc    crt0 = 1
+    INCLUDE "target/8080/classic/memmap.inc"
     INCLUDE "zcc_opt.def"
 
     EXTERN    _main           ;main() is always external to crt0 code
@@ -15,14 +16,31 @@ IFNDEF CLIB_FGETC_CONS_DELAY
 ENDIF
 
     defc    TAR__clib_exit_stack_size = 4
-    defc    TAR__register_sp = 0x0000
+    defc    TAR__register_sp = MEM_STACK_TOP
     defc    CRT_KEY_DEL = 12
     defc    __CPU_CLOCK = 3125000
     defc    CONSOLE_COLUMNS = 64
     defc    CONSOLE_ROWS = 32
+
+; -pragma-define:CRT_FAST_INIT=1 zeroes BSS below instead of crt0_init_bss, which clears one byte
+; per iteration, crt0_init_bss is still called for library initialisation; with 5224-byte BSS of
+; Dhrystone it takes 37328 cycles from reset to main() instead of 141644 (sbcemu, datasheet cycles)
+IF DEFINED_CRT_FAST_INIT
+    defc    CRT_INITIALIZE_BSS = 0
+ENDIF
     INCLUDE "crt/classic/crt_rules.inc"
 
-    defc    CRT_ORG_CODE = 0x0000
+    defc    CRT_ORG_CODE = MEM_CODE_START
+
+; end of space image (code, data and BSS) may take, sbcemu and sbcbench stop if __BSS_END_tail of
+; .map file is above it; -pragma-define:CRT_NO_DATA_REGION=1 is for programs that keep nothing at
+; MEM_DATA_START, so image may grow up to small number slots
+    PUBLIC  __IMAGE_END
+IF DEFINED_CRT_NO_DATA_REGION
+    defc    __IMAGE_END = MEM_DATA_END
+ELSE
+    defc    __IMAGE_END = MEM_CODE_END
+ENDIF
 
     org	    CRT_ORG_CODE
 
@@ -36,6 +54,69 @@ endif
 program:
     INCLUDE "crt/classic/crt_init_sp.asm"
     INCLUDE "crt/classic/crt_init_atexit.asm"
+IF DEFINED_CRT_FAST_INIT
+    EXTERN  __BSS_head
+    EXTERN  __BSS_END_tail
+
+    ; bc = BSS size / 16, a = BSS size % 16
+    ld      hl,__BSS_END_tail - __BSS_head
+    ld      a,l
+    and     15
+    ld      d,a
+    ld      b,4
+fast_init_shift:
+    ld      a,h
+    or      a
+    rra
+    ld      h,a
+    ld      a,l
+    rra
+    ld      l,a
+    dec     b
+    jp      nz,fast_init_shift
+    ld      b,h
+    ld      c,l
+
+    ; size % 16 bytes at the bottom are cleared one by one
+    ld      hl,__BSS_head
+    xor     a
+    inc     d
+    jp      fast_init_byte_next
+fast_init_byte:
+    ld      (hl),a
+    inc     hl
+fast_init_byte_next:
+    dec     d
+    jp      nz,fast_init_byte
+
+    ; the rest is zeroed from the top by pushing 0 with SP pointed at it, 16 bytes per iteration,
+    ; interrupts are still disabled, so nothing else uses stack meanwhile
+    ld      hl,0
+    add     hl,sp
+    ex      de,hl
+    ld      hl,__BSS_END_tail
+    ld      sp,hl
+    ld      hl,0
+    ld      a,b
+    or      c
+    jp      z,fast_init_done
+fast_init_push:
+    push    hl
+    push    hl
+    push    hl
+    push    hl
+    push    hl
+    push    hl
+    push    hl
+    push    hl
+    dec     bc
+    ld      a,b
+    or      c
+    jp      nz,fast_init_push
+fast_init_done:
+    ex      de,hl
+    ld      sp,hl
+ENDIF
     call    crt0_init_bss
     ld      hl,0
     add     hl,sp
@@ -52,6 +133,11 @@ ENDIF
     pop     bc
     pop     bc
 cleanup:
+; queued console output is sent before exit, -pragma-define:CONS_FIFO=1 together with hal.asm built with CONS_FIFO
+IF DEFINED_CONS_FIFO
+    EXTERN  cons_flush
+    call    cons_flush
+ENDIF
     call    crt0_exit
 
     INCLUDE "crt/classic/crt_terminate.inc"
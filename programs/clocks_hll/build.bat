@@ -3,4 +3,5 @@
 SET ZCCCFG=%Z88DK_DIR%lib\config\
 SET PATH=%Z88DK_DIR%bin;%PATH%
 
-zcc +8080 main.c ../../shared/hal.asm -m -o clocks_hll
\ No newline at end of file
+zcc +8080 main.c ../../shared/fmt.c ../../shared/ticks.c ../../shared/ticks.asm ../../shared/hal.asm -m -o clocks_hll
+zcc +8080 main.c ../../shared/fmt.c ../../shared/ticks.c ../../shared/ticks.asm ../../shared/hal.asm -Ca-DCONS_FIFO -pragma-define:CONS_FIFO=1 -m -o clocks_hll_fifo
\ No newline at end of file
@@ -1,27 +1,41 @@
-#include <stdio.h>
 #include <stdint.h>
+#include "../../shared/fmt.h"
+#include "../../shared/ticks.h"
 
-void storeTime(uint8_t * dst) {
-   *dst = *(uint8_t *)0xF880;
-   *(dst + 1) = *(uint8_t *)0xF881;
-   *(dst + 2) = *(uint8_t *)0xF882;
-   *(dst + 3) = *(uint8_t *)0xF883;
-   *(dst + 4) = *(uint8_t *)0xF884;
-}
+// bytes written by each console output measurement
+#define CONS_TEST_LEN     64
 
-void printTime(char * prefix, uint8_t * tm) {
-   printf("%s: %02X%02X%02X%02X%02X ticks\n", prefix, *(tm + 4), *(tm + 3), *(tm + 2), *(tm + 1), *tm);
-}
+static uint8_t consTest[CONS_TEST_LEN];
 
 int main()
 {
-   uint8_t startTime[5], endTime[5];
+   ticks_t startTime, endTime, elapsedTime;
+
+   ticks_snapshot(&startTime);
+   fmt_printf("Hello World !\n");
+   ticks_snapshot(&endTime);
+
+   ticks_print("Start", &startTime);
+   ticks_print("End", &endTime);
+
+   // cost of console output, with CONS_FIFO it is the cost of queueing, which is paid instead of waiting for port
+   for (uint8_t i = 0; i < CONS_TEST_LEN; i++) {
+      consTest[i] = i < CONS_TEST_LEN - 1 ? '.' : '\n';
+   }
+
+   ticks_snapshot(&startTime);
+   for (uint8_t i = 0; i < CONS_TEST_LEN; i++) {
+      fputc_cons_native(consTest[i]);
+   }
+   ticks_snapshot(&endTime);
+   ticks_elapsed(&elapsedTime, &startTime, &endTime);
+   ticks_print("fputc_cons_native x64", &elapsedTime);
 
-   storeTime(startTime);
-   printf("Hello World !\n");
-   storeTime(endTime);
+   ticks_snapshot(&startTime);
+   cons_write(consTest, CONS_TEST_LEN);
+   ticks_snapshot(&endTime);
+   ticks_elapsed(&elapsedTime, &startTime, &endTime);
+   ticks_print("cons_write 64 bytes", &elapsedTime);
 
-   printTime("Start", startTime);
-   printTime("End", endTime);
    return 0;
 }
@@ -3,4 +3,7 @@
 SET ZCCCFG=%Z88DK_DIR%lib\config\
 SET PATH=%Z88DK_DIR%bin;%PATH%
 
-zcc +8080 core_list_join.c core_main.c core_matrix.c core_state.c core_util.c core_portme.c ../../shared/hal.asm -DPERFORMANCE_RUN=1 -DITERATIONS=10 -O2 -m -o coremark
+zcc +8080 core_list_join.c core_main.c core_matrix.c core_state.c core_util.c core_portme.c ../../shared/fmt.c ../../shared/ticks.c ../../shared/ticks.asm ../../shared/hal.asm -DPERFORMANCE_RUN=1 -DITERATIONS=10 -pragma-define:CRT_NO_DATA_REGION=1 -O2 -m -o coremark
+zcc +8080 core_list_join.c core_main.c core_matrix.c core_state.c core_util.c core_portme.c ../../shared/fmt.c ../../shared/ticks.c ../../shared/ticks.asm ../../shared/hal.asm -DPERFORMANCE_RUN=1 -DITERATIONS=10 -pragma-define:CRT_NO_DATA_REGION=1 -DCORE_KERNEL_TIMING=1 -O2 -m -o coremark_kernels
+zcc +8080 core_list_join.c core_main.c core_matrix.c core_state.c core_util.c core_portme.c core_crc.asm ../../shared/fmt.c ../../shared/ticks.c ../../shared/ticks.asm ../../shared/hal.asm -DPERFORMANCE_RUN=1 -DITERATIONS=10 -pragma-define:CRT_NO_DATA_REGION=1 -DCORE_TUNED_CRC=1 -O2 -m -o coremark_tuned
+zcc +8080 core_list_join.c core_main.c core_matrix.c core_state.c core_util.c core_portme.c ../../shared/arith.asm ../../shared/fmt.c ../../shared/ticks.c ../../shared/ticks.asm ../../shared/hal.asm -DPERFORMANCE_RUN=1 -DITERATIONS=10 -pragma-define:CRT_NO_DATA_REGION=1 -DCORE_TUNED_MUL=1 -O2 -m -o coremark_tuned_mul
\ No newline at end of file
@@ -88,17 +88,21 @@ calc_func(ee_s16 *pdata, core_results *res)
             case 0:
                 if (dtype < 0x22) /* set min period for bit corruption */
                     dtype = 0x22;
+                PORTME_KERNEL_START(KERNEL_STATE);
                 retval = core_bench_state(res->size,
                                           res->memblock[3],
                                           res->seed1,
                                           res->seed2,
                                           dtype,
                                           res->crc);
+                PORTME_KERNEL_STOP();
                 if (res->crcstate == 0)
                     res->crcstate = retval;
                 break;
             case 1:
+                PORTME_KERNEL_START(KERNEL_MATRIX);
                 retval = core_bench_matrix(&(res->mat), dtype, res->crc);
+                PORTME_KERNEL_STOP();
                 if (res->crcmatrix == 0)
                     res->crcmatrix = retval;
                 break;
@@ -62,9 +62,13 @@ iterate(void *pres)
 
     for (i = 0; i < iterations; i++)
     {
+        PORTME_KERNEL_START(KERNEL_LIST);
         crc      = core_bench_list(res, 1);
+        PORTME_KERNEL_STOP();
         res->crc = crcu16(crc, res->crc);
+        PORTME_KERNEL_START(KERNEL_LIST);
         crc      = core_bench_list(res, -1);
+        PORTME_KERNEL_STOP();
         res->crc = crcu16(crc, res->crc);
         if (i == 0)
             res->crclist = res->crc;
@@ -373,6 +377,9 @@ for (i = 0; i < MULTITHREAD; i++)
         ee_printf("Iterations/Sec   : %d\n",
                   default_num_contexts * results[0].iterations
                       / time_in_secs(total_time));
+#endif
+#if CORE_KERNEL_TIMING
+    portme_kernel_report();
 #endif
     if (time_in_secs(total_time) < 10)
     {
@@ -273,7 +273,7 @@ matrix_mul_const(ee_u32 N, MATRES *C, MATDAT *A, MATDAT val)
     {
         for (j = 0; j < N; j++)
         {
-            C[i * N + j] = (MATRES)A[i * N + j] * (MATRES)val;
+            C[i * N + j] = MATMUL(A[i * N + j], val);
         }
     }
 }
@@ -308,7 +308,7 @@ matrix_mul_vect(ee_u32 N, MATRES *C, MATDAT *A, MATDAT *B)
         C[i] = 0;
         for (j = 0; j < N; j++)
         {
-            C[i] += (MATRES)A[i * N + j] * (MATRES)B[j];
+            C[i] += MATMUL(A[i * N + j], B[j]);
         }
     }
 }
@@ -329,7 +329,7 @@ matrix_mul_matrix(ee_u32 N, MATRES *C, MATDAT *A, MATDAT *B)
             C[i * N + j] = 0;
             for (k = 0; k < N; k++)
             {
-                C[i * N + j] += (MATRES)A[i * N + k] * (MATRES)B[k * N + j];
+                C[i * N + j] += MATMUL(A[i * N + k], B[k * N + j]);
             }
         }
     }
@@ -351,7 +351,7 @@ matrix_mul_matrix_bitextract(ee_u32 N, MATRES *C, MATDAT *A, MATDAT *B)
             C[i * N + j] = 0;
             for (k = 0; k < N; k++)
             {
-                MATRES tmp = (MATRES)A[i * N + k] * (MATRES)B[k * N + j];
+                MATRES tmp = MATMUL(A[i * N + k], B[k * N + j]);
                 C[i * N + j] += bit_extract(tmp, 2, 4) * bit_extract(tmp, 5, 7);
             }
         }
@@ -19,6 +19,7 @@ Original Author: Shay Gal-on
 #include <stdio.h>
 #include <stdlib.h>
 #include "coremark.h"
+#include "../../shared/ticks.h"
 
 /* Porting : Timing functions
         How to capture time and convert to seconds must be ported to whatever is
@@ -26,12 +27,17 @@ Original Author: Shay Gal-on
    cpu clock cycles performance counter etc. Sample implementation for standard
    time.h and windows.h definitions included.
 */
-#define EE_TICKS_PER_SEC           3125000
-
-volatile unsigned long * currentTime = (unsigned long *)0xF880;
+/* Configuration : TIMER_RES_SHIFT
+        Elapsed ticks are shifted right by this amount of bits before they are
+   returned as CORE_TICKS, 32-bit value of CPU cycles wraps after ~23 minutes.
+*/
+#ifndef TIMER_RES_SHIFT
+#define TIMER_RES_SHIFT 0
+#endif
+#define EE_TICKS_PER_SEC           (__CPU_CLOCK >> TIMER_RES_SHIFT)
 
 /** Define Host specific (POSIX), or target specific global time variables. */
-static unsigned long start_time_val, stop_time_val;
+static ticks_t start_time_val, stop_time_val;
 
 ee_s32 portme_sys1() {
 #if VALIDATION_RUN
@@ -78,6 +84,56 @@ ee_s32 portme_sys5() {
   return 0;
 }
 
+#if CORE_KERNEL_TIMING
+static ee_u8   kernel_timing_enabled = 0;
+static ee_u8   kernel_current        = KERNEL_NONE;
+static ee_u8   kernel_stack[KERNEL_COUNT];
+static ee_u8   kernel_depth = 0;
+static ticks_t kernel_last;
+static ee_u32  kernel_ticks[KERNEL_COUNT];
+
+static void
+kernel_switch(ee_u8 next)
+{
+    ticks_t now, elapsed;
+    ticks_snapshot(&now);
+    if (kernel_current != KERNEL_NONE)
+    {
+        ticks_elapsed(&elapsed, &kernel_last, &now);
+        kernel_ticks[kernel_current] += ticks_toU32(&elapsed, 0);
+    }
+    kernel_current = next;
+    /* bookkeeping above is not attributed to any kernel */
+    ticks_snapshot(&kernel_last);
+}
+
+void
+portme_kernel_start(ee_u8 kernel)
+{
+    if (!kernel_timing_enabled)
+        return;
+    kernel_stack[kernel_depth++] = kernel_current;
+    kernel_switch(kernel);
+}
+
+void
+portme_kernel_stop(void)
+{
+    if (!kernel_timing_enabled)
+        return;
+    kernel_switch(kernel_stack[--kernel_depth]);
+}
+
+void
+portme_kernel_report(void)
+{
+    ee_printf("List ticks       : %lu\n", kernel_ticks[KERNEL_LIST]);
+    ee_printf("Matrix ticks     : %lu\n", kernel_ticks[KERNEL_MATRIX]);
+    ee_printf("State ticks      : %lu\n", kernel_ticks[KERNEL_STATE]);
+    ee_printf("CRC ticks        : %lu\n", kernel_ticks[KERNEL_CRC]);
+}
+#endif
+
 /* Function : start_time
         This function will be called right before starting the timed portion of
    the benchmark.
@@ -89,7 +145,15 @@ ee_s32 portme_sys5() {
 void
 start_time(void)
 {
-  start_time_val = * currentTime;
+#if CORE_KERNEL_TIMING
+  ee_u8 i;
+  for (i = 0; i < KERNEL_COUNT; i++)
+    kernel_ticks[i] = 0;
+  kernel_current        = KERNEL_NONE;
+  kernel_depth          = 0;
+  kernel_timing_enabled = 1;
+#endif
+  ticks_snapshot(&start_time_val);
 }
 /* Function : stop_time
         This function will be called right after ending the timed portion of the
@@ -102,7 +166,10 @@ start_time(void)
 void
 stop_time(void)
 {
-  stop_time_val = * currentTime;
+  ticks_snapshot(&stop_time_val);
+#if CORE_KERNEL_TIMING
+  kernel_timing_enabled = 0;
+#endif
 }
 /* Function : get_time
         Return an abstract "ticks" number that signifies time on the system.
@@ -116,8 +183,9 @@ stop_time(void)
 CORE_TICKS
 get_time(void)
 {
-    CORE_TICKS elapsed = (CORE_TICKS)(stop_time_val - start_time_val);
-    return elapsed;
+    ticks_t elapsed;
+    ticks_elapsed(&elapsed, &start_time_val, &stop_time_val);
+    return (CORE_TICKS)ticks_toU32(&elapsed, TIMER_RES_SHIFT);
 }
 /* Function : time_in_secs
         Convert the value returned by get_time to seconds.
@@ -156,6 +224,9 @@ portable_init(core_portable *p, int *argc, char *argv[])
     {
         ee_printf("ERROR! Please define ee_u32 to a 32b unsigned type!\n");
     }
+#if CORE_TUNED_CRC || CORE_TUNED_MUL
+    ee_printf("TUNED build, not a valid CoreMark result\n");
+#endif
     p->portable_id = 1;
 }
 /* Function : portable_fini
@@ -53,10 +53,15 @@ Original Author: Shay Gal-on
 #endif
 /* Configuration : HAS_PRINTF
         Define to 1 if the platform has stdio.h and implements the printf
-   function.
+   function. Library printf is not used, ee_printf is mapped to fmt_printf
+   from shared/fmt.c, which has all conversions needed without float ones.
 */
 #ifndef HAS_PRINTF
-#define HAS_PRINTF 1
+#define HAS_PRINTF 0
+#endif
+#if !HAS_PRINTF
+#include "../../shared/fmt.h"
+#define ee_printf fmt_printf
 #endif
 
 /* Configuration : CORE_TICKS
@@ -75,9 +80,39 @@ typedef unsigned long CORE_TICKS;
 #define COMPILER_VERSION "zcc"
 #endif
 #endif
+/* Configuration : CORE_TUNED_CRC
+        Define to 1 to replace bitwise crcu8/crcu16 with table-driven ones from
+   core_crc.asm. CRC values are the same, but such build doesn't follow
+   CoreMark run rules, so it is labelled in compiler flags. CRC calls are not
+   instrumented by CORE_KERNEL_TIMING in this build.
+*/
+#ifndef CORE_TUNED_CRC
+#define CORE_TUNED_CRC 0
+#endif
+/* Configuration : CORE_TUNED_MUL
+        Define to 1 to compute 16x16 bit products of matrix kernels with
+   smul16x16 from shared/arith.asm instead of generic 32x32 bit multiplication.
+   Results are the same, but matrix code goes through MATMUL, so such build
+   doesn't follow CoreMark run rules either.
+*/
+#ifndef CORE_TUNED_MUL
+#define CORE_TUNED_MUL 0
+#endif
+#if CORE_TUNED_MUL
+#include "../../shared/arith.h"
+#define MATMUL(a, b) smul16x16((a), (b))
+#endif
 #ifndef COMPILER_FLAGS
+#if CORE_TUNED_CRC && CORE_TUNED_MUL
+#define COMPILER_FLAGS "-O2 TUNED (asm table CRC16, asm 16x16 multiply, non-compliant)"
+#elif CORE_TUNED_CRC
+#define COMPILER_FLAGS "-O2 TUNED (asm table CRC16, non-compliant)"
+#elif CORE_TUNED_MUL
+#define COMPILER_FLAGS "-O2 TUNED (asm 16x16 multiply, non-compliant)"
+#else
 #define COMPILER_FLAGS "-O2"
 #endif
+#endif
 #ifndef MEM_LOCATION
 #define MEM_LOCATION "STATIC"
 #endif
@@ -179,6 +214,36 @@ typedef size_t         ee_size_t;
 #define MAIN_HAS_NORETURN 0
 #endif
 
+/* Configuration : CORE_KERNEL_TIMING
+        Define to 1 to build instrumented port, which accumulates ticks
+   separately for list, matrix and state kernels and CRC calls inside of
+   timed region. Each kernel switch adds a few hundred ticks of instrumentation
+   to total time, so such run is not a valid CoreMark result.
+*/
+#ifndef CORE_KERNEL_TIMING
+#define CORE_KERNEL_TIMING 0
+#endif
+
+#if CORE_KERNEL_TIMING
+#define KERNEL_NONE   0
+#define KERNEL_LIST   1
+#define KERNEL_MATRIX 2
+#define KERNEL_STATE  3
+#define KERNEL_CRC    4
+#define KERNEL_COUNT  5
+
+/* time spent in nested kernel is excluded from time of outer one */
+void portme_kernel_start(ee_u8 kernel);
+void portme_kernel_stop(void);
+void portme_kernel_report(void);
+
+#define PORTME_KERNEL_START(kernel) portme_kernel_start(kernel)
+#define PORTME_KERNEL_STOP()        portme_kernel_stop()
+#else
+#define PORTME_KERNEL_START(kernel)
+#define PORTME_KERNEL_STOP()
+#endif
+
 /* Variable : default_num_contexts
         Not used for this simple port, must contain the value 1.
 */
@@ -162,7 +162,9 @@ get_seed_32(int i)
 /* Function: crc*
         Service functions to calculate 16b CRC code.
 
+        Tuned build takes crcu8 and crcu16 from table-driven core_crc.asm
 */
+#if !CORE_TUNED_CRC
 ee_u16
 crcu8(ee_u8 data, ee_u16 crc)
 {
@@ -191,10 +193,13 @@ crcu8(ee_u8 data, ee_u16 crc)
 ee_u16
 crcu16(ee_u16 newval, ee_u16 crc)
 {
+    PORTME_KERNEL_START(KERNEL_CRC);
     crc = crcu8((ee_u8)(newval), crc);
     crc = crcu8((ee_u8)((newval) >> 8), crc);
+    PORTME_KERNEL_STOP();
     return crc;
 }
+#endif
 ee_u16
 crcu32(ee_u32 newval, ee_u16 crc)
 {
@@ -109,6 +109,10 @@ typedef ee_s32 MATRES;
 typedef ee_f16 MATDAT;
 typedef ee_f32 MATRES;
 #endif
+/* port may provide faster MATDAT x MATDAT -> MATRES product */
+#ifndef MATMUL
+#define MATMUL(a, b) ((MATRES)(a) * (MATRES)(b))
+#endif
 
 typedef struct MAT_PARAMS_S
 {
@@ -3,4 +3,6 @@
 SET ZCCCFG=%Z88DK_DIR%lib\config\
 SET PATH=%Z88DK_DIR%bin;%PATH%
 
-zcc +8080 dhry_1.c dhry_2.c ../../shared/hal.asm -O2 -m -o dhrystone
\ No newline at end of file
+zcc +8080 dhry_1.c dhry_2.c ../../shared/fmt.c ../../shared/ticks.c ../../shared/ticks.asm ../../shared/hal.asm -DDHRY_ITERS=2000 -O2 -m -o dhrystone
+zcc +8080 dhry_1.c dhry_2.c ../../shared/fmt.c ../../shared/ticks.c ../../shared/ticks.asm ../../shared/hal.asm -DDHRY_ITERS=2000 -pragma-define:CRT_FAST_INIT=1 -O2 -m -o dhrystone_fast_init
+zcc +8080 dhry_1.c dhry_2.c ../../shared/strings.asm ../../shared/fmt.c ../../shared/ticks.c ../../shared/ticks.asm ../../shared/hal.asm -DFAST_STRING -DDHRY_ITERS=2000 -O2 -m -o dhrystone_fast_string
\ No newline at end of file
@@ -348,6 +348,8 @@
 
 #ifdef  NOSTRUCTASSIGN
 #define structassign(d, s)      memcpy(&(d), &(s), sizeof(d))
+#elif defined(FAST_STRING)
+#define structassign(d, s)      fast_memcpy(&(d), &(s), sizeof(d))
 #else
 #define structassign(d, s)      d = s
 #endif
@@ -370,6 +372,13 @@
 #include <stdio.h>
                 /* for strcpy, strcmp */
 
+#ifdef  FAST_STRING
+                /* assembly versions from shared/strings.asm */
+#include "../../shared/strings.h"
+#define strcpy  fast_strcpy
+#define strcmp  fast_strcmp
+#endif
+
 #define Null 0 
                 /* Value of a Null pointer */
 #define true  1
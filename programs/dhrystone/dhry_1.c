@@ -16,11 +16,29 @@
  */
 
 #include "dhry.h"
+#include "../../shared/fmt.h"
+#include "../../shared/memmap.h"
+#include "../../shared/ticks.h"
 
+/* number of runs is a build parameter, -DDHRY_ITERS=nnn */
 #ifndef DHRY_ITERS
 #define DHRY_ITERS 2000
 #endif
 
+/* Number_Of_Runs is 16-bit int, Arr_2_Glob [8][7] overflows beyond 32000 runs */
+#if DHRY_ITERS > 32000
+#error "DHRY_ITERS should not exceed 32000"
+#endif
+
+/* VAX 11/780 result, which is 1 DMIPS */
+#define DHRY_VAX_PER_SEC 1757
+
+#ifdef FAST_STRING
+#define DHRY_VARIANT "fast_string"
+#else
+#define DHRY_VARIANT "default"
+#endif
+
 /* Global Variables: */
 
 Rec_Pointer     Ptr_Glob,
@@ -34,6 +52,7 @@ int             Arr_2_Glob [50] [50];
 
 Enumeration     Func_1 ();
   /* forward declaration necessary since Enumeration may not simply be int */
+static uint32_t mul_div (uint32_t a, uint32_t b, uint32_t c);
 
 #ifndef REG
         Boolean Reg = false;
@@ -44,9 +63,7 @@ Enumeration     Func_1 ();
         Boolean Reg = true;
 #endif
 
-long * currentTime = (long *)0xF880;
-
-long Begin_Time, End_Time;
+ticks_t Startup_Time, Begin_Time, End_Time, Elapsed_Time;
 
 main ()
 /*****/
@@ -64,10 +81,13 @@ main ()
   REG   int             Run_Index;
   REG   int             Number_Of_Runs;
 
+  /* counter value at entry is the startup cost from reset, BSS clearing is most of it */
+  ticks_snapshot(&Startup_Time);
+
   /* Initializations */
 
-  Next_Ptr_Glob = (Rec_Pointer) 0x8000;
-  Ptr_Glob = (Rec_Pointer) 0xA000;
+  Next_Ptr_Glob = (Rec_Pointer) MEM_DHRY_NEXT_REC;
+  Ptr_Glob = (Rec_Pointer) MEM_DHRY_REC;
 
   Ptr_Glob->Ptr_Comp                    = Next_Ptr_Glob;
   Ptr_Glob->Discr                       = Ident_1;
@@ -83,38 +103,33 @@ main ()
         /* Warning: With 16-Bit processors and Number_Of_Runs > 32000,  */
         /* overflow may occur for this array element.                   */
 
-  printf ("\n");
-  printf ("Dhrystone Benchmark, Version 2.1 (Language: C)\n");
-  printf ("\n");
+  fmt_printf ("\n");
+  fmt_printf ("Dhrystone Benchmark, Version 2.1 (Language: C)\n");
+  fmt_printf ("\n");
+#ifdef FAST_STRING
+  fmt_printf ("FAST_STRING build: memcpy, strcpy, strcmp from shared/strings.asm\n");
+  fmt_printf ("\n");
+#endif
   if (Reg)
   {
-    printf ("Program compiled with 'register' attribute\n");
-    printf ("\n");
+    fmt_printf ("Program compiled with 'register' attribute\n");
+    fmt_printf ("\n");
   }
   else
   {
-    printf ("Program compiled without 'register' attribute\n");
-    printf ("\n");
+    fmt_printf ("Program compiled without 'register' attribute\n");
+    fmt_printf ("\n");
   }
-#ifdef DHRY_ITERS
   Number_Of_Runs = DHRY_ITERS;
-#else
-  printf ("Please give the number of runs through the benchmark: ");
-  {
-    int n;
-    scanf ("%d", &n);
-    Number_Of_Runs = n;
-  }
-  printf ("\n");
-#endif
 
-  printf ("Execution starts, %d runs through Dhrystone\n", Number_Of_Runs);
+  ticks_print ("Startup", &Startup_Time);
+  fmt_printf ("Execution starts, %d runs through Dhrystone\n", Number_Of_Runs);
 
   /***************/
   /* Start timer */
   /***************/
 
-  Begin_Time = * currentTime;
+  ticks_snapshot(&Begin_Time);
 
   for (Run_Index = 1; Run_Index <= Number_Of_Runs; ++Run_Index)
   {
@@ -172,61 +187,122 @@ main ()
   /* Stop timer */
   /**************/
 
-  End_Time = * currentTime;
-
-  printf ("Execution ends\n");
-  printf ("  Elapsed: %ld ticks\n", End_Time - Begin_Time);
-  printf ("\n");
-  printf ("Final values of the variables used in the benchmark:\n");
-  printf ("\n");
-  printf ("Int_Glob:            %d\n", Int_Glob);
-  printf ("        should be:   %d\n", 5);
-  printf ("Bool_Glob:           %d\n", Bool_Glob);
-  printf ("        should be:   %d\n", 1);
-  printf ("Ch_1_Glob:           %c\n", Ch_1_Glob);
-  printf ("        should be:   %c\n", 'A');
-  printf ("Ch_2_Glob:           %c\n", Ch_2_Glob);
-  printf ("        should be:   %c\n", 'B');
-  printf ("Arr_1_Glob[8]:       %d\n", Arr_1_Glob[8]);
-  printf ("        should be:   %d\n", 7);
-  printf ("Arr_2_Glob[8][7]:    %d\n", Arr_2_Glob[8][7]);
-  printf ("        should be:   Number_Of_Runs + 10\n");
-  printf ("Ptr_Glob->\n");
-  printf ("  Ptr_Comp:          %d\n", (int) Ptr_Glob->Ptr_Comp);
-  printf ("        should be:   (implementation-dependent)\n");
-  printf ("  Discr:             %d\n", Ptr_Glob->Discr);
-  printf ("        should be:   %d\n", 0);
-  printf ("  Enum_Comp:         %d\n", Ptr_Glob->variant.var_1.Enum_Comp);
-  printf ("        should be:   %d\n", 2);
-  printf ("  Int_Comp:          %d\n", Ptr_Glob->variant.var_1.Int_Comp);
-  printf ("        should be:   %d\n", 17);
-  printf ("  Str_Comp:          %s\n", Ptr_Glob->variant.var_1.Str_Comp);
-  printf ("        should be:   DHRYSTONE PROGRAM, SOME STRING\n");
-  printf ("Next_Ptr_Glob->\n");
-  printf ("  Ptr_Comp:          %d\n", (int) Next_Ptr_Glob->Ptr_Comp);
-  printf ("        should be:   (implementation-dependent), same as above\n");
-  printf ("  Discr:             %d\n", Next_Ptr_Glob->Discr);
-  printf ("        should be:   %d\n", 0);
-  printf ("  Enum_Comp:         %d\n", Next_Ptr_Glob->variant.var_1.Enum_Comp);
-  printf ("        should be:   %d\n", 1);
-  printf ("  Int_Comp:          %d\n", Next_Ptr_Glob->variant.var_1.Int_Comp);
-  printf ("        should be:   %d\n", 18);
-  printf ("  Str_Comp:          %s\n",
+  ticks_snapshot(&End_Time);
+  ticks_elapsed(&Elapsed_Time, &Begin_Time, &End_Time);
+
+  fmt_printf ("Execution ends\n");
+  fmt_printf ("  Elapsed: %lu ticks, ", ticks_toU32(&Elapsed_Time, 0));
+  fmt_seconds (ticks_toU32(&Elapsed_Time, 0), __CPU_CLOCK);
+  fmt_printf (" s\n");
+  fmt_printf ("\n");
+  fmt_printf ("Final values of the variables used in the benchmark:\n");
+  fmt_printf ("\n");
+  fmt_printf ("Int_Glob:            %d\n", Int_Glob);
+  fmt_printf ("        should be:   %d\n", 5);
+  fmt_printf ("Bool_Glob:           %d\n", Bool_Glob);
+  fmt_printf ("        should be:   %d\n", 1);
+  fmt_printf ("Ch_1_Glob:           %c\n", Ch_1_Glob);
+  fmt_printf ("        should be:   %c\n", 'A');
+  fmt_printf ("Ch_2_Glob:           %c\n", Ch_2_Glob);
+  fmt_printf ("        should be:   %c\n", 'B');
+  fmt_printf ("Arr_1_Glob[8]:       %d\n", Arr_1_Glob[8]);
+  fmt_printf ("        should be:   %d\n", 7);
+  fmt_printf ("Arr_2_Glob[8][7]:    %d\n", Arr_2_Glob[8][7]);
+  fmt_printf ("        should be:   Number_Of_Runs + 10\n");
+  fmt_printf ("Ptr_Glob->\n");
+  fmt_printf ("  Ptr_Comp:          %d\n", (int) Ptr_Glob->Ptr_Comp);
+  fmt_printf ("        should be:   (implementation-dependent)\n");
+  fmt_printf ("  Discr:             %d\n", Ptr_Glob->Discr);
+  fmt_printf ("        should be:   %d\n", 0);
+  fmt_printf ("  Enum_Comp:         %d\n", Ptr_Glob->variant.var_1.Enum_Comp);
+  fmt_printf ("        should be:   %d\n", 2);
+  fmt_printf ("  Int_Comp:          %d\n", Ptr_Glob->variant.var_1.Int_Comp);
+  fmt_printf ("        should be:   %d\n", 17);
+  fmt_printf ("  Str_Comp:          %s\n", Ptr_Glob->variant.var_1.Str_Comp);
+  fmt_printf ("        should be:   DHRYSTONE PROGRAM, SOME STRING\n");
+  fmt_printf ("Next_Ptr_Glob->\n");
+  fmt_printf ("  Ptr_Comp:          %d\n", (int) Next_Ptr_Glob->Ptr_Comp);
+  fmt_printf ("        should be:   (implementation-dependent), same as above\n");
+  fmt_printf ("  Discr:             %d\n", Next_Ptr_Glob->Discr);
+  fmt_printf ("        should be:   %d\n", 0);
+  fmt_printf ("  Enum_Comp:         %d\n", Next_Ptr_Glob->variant.var_1.Enum_Comp);
+  fmt_printf ("        should be:   %d\n", 1);
+  fmt_printf ("  Int_Comp:          %d\n", Next_Ptr_Glob->variant.var_1.Int_Comp);
+  fmt_printf ("        should be:   %d\n", 18);
+  fmt_printf ("  Str_Comp:          %s\n",
                                 Next_Ptr_Glob->variant.var_1.Str_Comp);
-  printf ("        should be:   DHRYSTONE PROGRAM, SOME STRING\n");
-  printf ("Int_1_Loc:           %d\n", Int_1_Loc);
-  printf ("        should be:   %d\n", 5);
-  printf ("Int_2_Loc:           %d\n", Int_2_Loc);
-  printf ("        should be:   %d\n", 13);
-  printf ("Int_3_Loc:           %d\n", Int_3_Loc);
-  printf ("        should be:   %d\n", 7);
-  printf ("Enum_Loc:            %d\n", Enum_Loc);
-  printf ("        should be:   %d\n", 1);
-  printf ("Str_1_Loc:           %s\n", Str_1_Loc);
-  printf ("        should be:   DHRYSTONE PROGRAM, 1'ST STRING\n");
-  printf ("Str_2_Loc:           %s\n", Str_2_Loc);
-  printf ("        should be:   DHRYSTONE PROGRAM, 2'ND STRING\n");
-  printf ("\n");
+  fmt_printf ("        should be:   DHRYSTONE PROGRAM, SOME STRING\n");
+  fmt_printf ("Int_1_Loc:           %d\n", Int_1_Loc);
+  fmt_printf ("        should be:   %d\n", 5);
+  fmt_printf ("Int_2_Loc:           %d\n", Int_2_Loc);
+  fmt_printf ("        should be:   %d\n", 13);
+  fmt_printf ("Int_3_Loc:           %d\n", Int_3_Loc);
+  fmt_printf ("        should be:   %d\n", 7);
+  fmt_printf ("Enum_Loc:            %d\n", Enum_Loc);
+  fmt_printf ("        should be:   %d\n", 1);
+  fmt_printf ("Str_1_Loc:           %s\n", Str_1_Loc);
+  fmt_printf ("        should be:   DHRYSTONE PROGRAM, 1'ST STRING\n");
+  fmt_printf ("Str_2_Loc:           %s\n", Str_2_Loc);
+  fmt_printf ("        should be:   DHRYSTONE PROGRAM, 2'ND STRING\n");
+  fmt_printf ("\n");
+
+  {
+    uint32_t ticks = ticks_toU32(&Elapsed_Time, 0);
+    uint32_t perSecX10 = 0;
+    uint32_t dmipsX1000 = 0;
+
+    if (ticks > 0)
+    {
+      perSecX10 = mul_div ((uint32_t) Number_Of_Runs * 10, __CPU_CLOCK, ticks);
+      dmipsX1000 = mul_div (perSecX10, 100, DHRY_VAX_PER_SEC);
+    }
+
+    fmt_printf ("Dhrystones per Second:      %lu.%u\n",
+                perSecX10 / 10, (unsigned int) (perSecX10 % 10));
+    fmt_printf ("DMIPS:                      %lu.%03u\n",
+                dmipsX1000 / 1000, (unsigned int) (dmipsX1000 % 1000));
+    fmt_printf ("\n");
+
+    /* single line for scripts */
+    fmt_printf ("DHRY variant=%s runs=%d ticks=%lu clock=%lu dps=%lu.%u dmips=%lu.%03u\n",
+                DHRY_VARIANT, Number_Of_Runs, ticks, (uint32_t) __CPU_CLOCK,
+                perSecX10 / 10, (unsigned int) (perSecX10 % 10),
+                dmipsX1000 / 1000, (unsigned int) (dmipsX1000 % 1000));
+  }
+}
+
+
+/* (a * b) / c without 64-bit intermediate, c should be below 2^31 */
+static uint32_t mul_div (uint32_t a, uint32_t b, uint32_t c)
+{
+  uint32_t quotient = (a / c) * b;
+  uint32_t remainder = a % c;
+  uint32_t partQuotient = 0;
+  uint32_t partRemainder = 0;
+  uint32_t mask;
+
+  /* (remainder * b) / c by shift-add, partRemainder stays below c */
+  for (mask = 0x80000000; mask != 0; mask >>= 1)
+  {
+    partQuotient <<= 1;
+    partRemainder <<= 1;
+    if (partRemainder >= c)
+    {
+      partRemainder -= c;
+      partQuotient++;
+    }
+    if (b & mask)
+    {
+      partRemainder += remainder;
+      if (partRemainder >= c)
+      {
+        partRemainder -= c;
+        partQuotient++;
+      }
+    }
+  }
+
+  return quotient + partQuotient;
 }
 
 
@@ -243,7 +319,7 @@ REG Rec_Pointer Ptr_Val_Par;
 
   Ptr_Val_Par->Ptr_Comp->Ptr_Comp = Ptr_Glob->Ptr_Comp;
   Ptr_Val_Par->Ptr_Comp->Discr = Ptr_Glob->Discr;
-  Ptr_Val_Par->Ptr_Comp->variant = Ptr_Glob->variant;
+  structassign (Ptr_Val_Par->Ptr_Comp->variant, Ptr_Glob->variant);
 
   Ptr_Val_Par->variant.var_1.Int_Comp = 5;
   Next_Record->variant.var_1.Int_Comp = Ptr_Val_Par->variant.var_1.Int_Comp;
@@ -3,4 +3,4 @@
 SET ZCCCFG=%Z88DK_DIR%lib\config\
 SET PATH=%Z88DK_DIR%bin;%PATH%
 
-zcc +8080 hello.c ../../shared/hal.asm -m -o hello
\ No newline at end of file
+zcc +8080 hello.c ../../shared/fmt.c ../../shared/hal.asm -m -o hello
\ No newline at end of file
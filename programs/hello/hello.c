@@ -1,9 +1,10 @@
 #include <stdio.h>
+#include "../../shared/fmt.h"
 
 int main()
 {
    fputc_cons(0x05);
-   printf("Hello World !\n");
+   fmt_printf("Hello World !\n");
    fputc_cons(0x05);
    return 0;
 }
@@ -2,6 +2,7 @@
 #include <stdio.h>
 
 #include "bn.h"
+#include "../../shared/hal.h"
 
 static uint16_t bn_ptr_mul(uint8_t * resultPtr, uint8_t * factor1Ptr, uint16_t factor1Size, uint8_t * factor2Ptr, uint16_t factor2Size, uint8_t * tmpPtr);
 
@@ -12,7 +13,7 @@ static uint16_t bn_ptr_size(uint8_t * srcPtr, uint16_t maxSize) {
     return 0;
   }
 
-  while (!srcPtr[i]) {
+  while (i && !srcPtr[i]) {
     --i;
   }
 
@@ -28,10 +29,16 @@ static char hex2char[16] = {
 };
 
 void bn_ptr_printHex(uint8_t * ptr, uint16_t used) {
+  uint8_t buf[CONS_BLOCK];
+  uint8_t len = 0;
   uint16_t i = used - 1;
   while (1) {
-    fputc_cons(hex2char[ptr[i] >> 4]);
-    fputc_cons(hex2char[ptr[i] & 0xF]);
+    buf[len++] = hex2char[ptr[i] >> 4];
+    buf[len++] = hex2char[ptr[i] & 0xF];
+    if (len == CONS_BLOCK) {
+      cons_write(buf, len);
+      len = 0;
+    }
 
     if (i == 0) {
       break;
@@ -39,7 +46,9 @@ void bn_ptr_printHex(uint8_t * ptr, uint16_t used) {
     --i;
   }
 
-  fputc_cons('\n');
+  // CONS_BLOCK is even, so there is always room for newline
+  buf[len++] = '\n';
+  cons_write(buf, len);
 }
 
 void bn_printHex(bn * src) {
@@ -194,7 +203,7 @@ static uint8_t bn_ptr_sub(uint8_t * resultPtr, uint8_t * minuendPtr, uint16_t mi
       if (minuendPtr[i] != 0) {
         resultPtr[i] = minuendPtr[i] - 1;
         if (resultPtr != minuendPtr) {
-          for (; i < minuendSize; ++i) {
+          for (++i; i < minuendSize; ++i) {
             resultPtr[i] = minuendPtr[i];
           }
         }
@@ -238,6 +247,9 @@ static void bn_ptr_decr(uint8_t * ptr, uint16_t size) {
   }
 }
 
+// digits of c saved while a and b are computed over it
+#define KARATSUBA_OVERLAP 8
+
 // size of resultPtr and tmpPtr should be at least factor1Size + factor2Size
 static void bn_ptr_mul_karatsuba(uint8_t * resultPtr, uint8_t * factor1Ptr, uint16_t factor1Size, uint8_t * factor2Ptr, uint16_t factor2Size, uint8_t * tmpPtr) {
   // in worst case factor1Size == factor2Size and it's odd
@@ -295,11 +307,10 @@ static void bn_ptr_mul_karatsuba(uint8_t * resultPtr, uint8_t * factor1Ptr, uint
   bn_ptr_mul(cPtr, xSum, xSumSize, ySum, ySumSize, &tmpPtr[ySumSize]);
 
   // some digits of c would be overlapped by temp variable, save them
-  uint8_t overlapped[4];
-  overlapped[0] = cPtr[0];
-  overlapped[1] = cPtr[1];
-  overlapped[2] = cPtr[2];
-  overlapped[3] = cPtr[3];
+  uint8_t overlapped[KARATSUBA_OVERLAP];
+  for (uint8_t i = 0; i < KARATSUBA_OVERLAP; i++) {
+    overlapped[i] = cPtr[i];
+  }
 
   // b = x1 * y1
   uint16_t bSize = hX + hY;
@@ -312,10 +323,9 @@ static void bn_ptr_mul_karatsuba(uint8_t * resultPtr, uint8_t * factor1Ptr, uint
   bn_ptr_mul(aPtr, xL, l, yL, l, resultPtr);
 
   // restore c digits
-  cPtr[0] = overlapped[0];
-  cPtr[1] = overlapped[1];
-  cPtr[2] = overlapped[2];
-  cPtr[3] = overlapped[3];
+  for (uint8_t i = 0; i < KARATSUBA_OVERLAP; i++) {
+    cPtr[i] = overlapped[i];
+  }
 
   // d = c - a - b
   bn_ptr_sub(cPtr, cPtr, cSize, aPtr, aSize);
@@ -333,7 +343,11 @@ static void bn_ptr_mul_karatsuba(uint8_t * resultPtr, uint8_t * factor1Ptr, uint
 static uint16_t bn_ptr_mul(uint8_t * resultPtr, uint8_t * factor1Ptr, uint16_t factor1Size, uint8_t * factor2Ptr, uint16_t factor2Size, uint8_t * tmpPtr) {
   uint16_t resultSize = factor1Size + factor2Size;
 
-  if (factor1Size > KARATSUBA_THRESHOLD_MUL && factor2Size > KARATSUBA_THRESHOLD_MUL) {
+  // a and b overwrite about (size difference + 1) lowest digits of c in bn_ptr_mul_karatsuba(),
+  // so only nearly balanced factors can use it
+  uint16_t sizeDiff = factor1Size > factor2Size ? factor1Size - factor2Size : factor2Size - factor1Size;
+  if (factor1Size > KARATSUBA_THRESHOLD_MUL && factor2Size > KARATSUBA_THRESHOLD_MUL
+      && sizeDiff <= KARATSUBA_OVERLAP - 4) {
     bn_ptr_mul_karatsuba(resultPtr, factor1Ptr, factor1Size, factor2Ptr, factor2Size, tmpPtr);
     return resultSize;
   }
@@ -399,7 +413,8 @@ static void bn_ptr_div_school(uint8_t * quotientPtr, uint8_t * dividendPtr, uint
     uint16_t quotientEst = dividendTwoHighest / divisorMsd;
     uint16_t reminderEst = dividendTwoHighest - (quotientEst * divisorMsd);
 
-    while ((quotientEst > 0xFF) || ((uint8_t)quotientEst * (uint16_t)divisorPtr[divisorMsdIdx - 1] > (reminderEst << 8) + dividendPtr[quotientIdx + divisorMsdIdx - 1])) {
+    // single-digit divisor has no second digit to refine estimate with
+    while ((quotientEst > 0xFF) || (divisorMsdIdx && (uint8_t)quotientEst * (uint16_t)divisorPtr[divisorMsdIdx - 1] > (reminderEst << 8) + dividendPtr[quotientIdx + divisorMsdIdx - 1])) {
       quotientEst = quotientEst - 1;
       reminderEst = reminderEst + divisorMsd;
       if (reminderEst > 0xFF) {
@@ -461,6 +476,29 @@ uint8_t bn_ptr_isEqual(uint8_t * firstPtr, uint8_t * secondPtr, uint16_t size) {
   return 1;
 }
 
+// sizes may include leading zero digits
+static uint8_t bn_ptr_isLess(uint8_t * firstPtr, uint16_t firstSize, uint8_t * secondPtr, uint16_t secondSize) {
+  for (; firstSize > secondSize; --firstSize) {
+    if (firstPtr[firstSize - 1]) {
+      return 0;
+    }
+  }
+
+  for (; secondSize > firstSize; --secondSize) {
+    if (secondPtr[secondSize - 1]) {
+      return 1;
+    }
+  }
+
+  for (uint16_t i = firstSize; i > 0; --i) {
+    if (firstPtr[i - 1] != secondPtr[i - 1]) {
+      return firstPtr[i - 1] < secondPtr[i - 1];
+    }
+  }
+
+  return 0;
+}
+
 // val = (val << 3) + (val << 1)
 void bn_mulBy10(bn * val, bn * tmpTerm) {
   uint16_t msd = val->used - 1;
@@ -579,7 +617,7 @@ static uint16_t bn_ptr_shiftRightByBits(uint8_t * resPtr, uint8_t * valPtr, uint
   return msd;
 }
 
-static void bn_ptr_shiftRight1bit(uint8_t * resPtr, uint8_t * valPtr, uint16_t valSize) {
+static uint8_t bn_ptr_shiftRight1bit(uint8_t * resPtr, uint8_t * valPtr, uint16_t valSize) {
   uint16_t i = 0;
   uint16_t msd = valSize - 1;
 
@@ -730,7 +768,10 @@ static uint16_t bn_sqrt_newton(uint8_t * nPtr, uint16_t nSize, uint8_t * rootPtr
       --nextXSize;
     }
 
-    if (nextXSize == xSize && bn_ptr_isEqual(nextX, rootPtr, xSize)) {
+    // x decreases until it's the root, nextX can be root + 1 then (e.g. for n = root * (root + 2));
+    // root of normalized n has half of its digits
+    if (!bn_ptr_isLess(nextX, nextXSize, rootPtr, xSize)) {
+      xSize = nSize >> 1;
       bn_ptr_mul(tmp, rootPtr, xSize, rootPtr, xSize, &tmp[0x100]);
       bn_ptr_sub(reminderPtr, nPtr, nSize, tmp, xSize + xSize);
       return bn_ptr_size(reminderPtr, nSize);
@@ -763,21 +804,33 @@ static uint16_t bn_sqrt_recursive(uint8_t * nPtr, uint16_t nSize, uint8_t * root
   uint16_t dividendSize = sqrtReminderSize + k;
   uint8_t lowestS1 = s1[0];
 
-  bn_ptr_div(rootPtr, aL1, dividendSize, tmp2, divisorSize, tmp0, aL1, tmp1, tmp3, 1);
+  // small r1 gives dividend shorter than divisor, then q is zero and u is the dividend
+  uint16_t quotientSize = 0;
+  if (dividendSize >= divisorSize) {
+    quotientSize = bn_ptr_div(rootPtr, aL1, dividendSize, tmp2, divisorSize, tmp0, aL1, tmp1, tmp3, 1) + 1;
+  }
 
-  s1[0] = lowestS1;
-  // root is computed
-  uint16_t quotientSize = dividendSize - divisorSize + 1;
+  // root is computed, q can be B^k (its digit k overwrote s1[0]), then q = B^k - 1 and u = u + 2 * s1
+  uint16_t reminderSize = divisorSize + k;
   if (quotientSize > k) {
-    --quotientSize;
+    if (rootPtr[k]) {
+      for (uint16_t i = 0; i < k; ++i) {
+        rootPtr[i] = 0xFF;
+      }
+      if (bn_ptr_add(aL1, tmp2, divisorSize, aL1, divisorSize)) {
+        aL1[divisorSize] = 1;
+        ++reminderSize;
+      }
+    }
+    quotientSize = k;
   } else {
     for (uint16_t i = quotientSize; i < k; ++i) {
       rootPtr[i] = 0;
     }
   }
+  s1[0] = lowestS1;
 
   // compute reminder
-  uint16_t reminderSize = divisorSize + k;
   bn_ptr_mul(tmp1, rootPtr, quotientSize, rootPtr, quotientSize, tmp2);
   if (bn_ptr_sub(reminderPtr, aL0, reminderSize, tmp1, quotientSize + quotientSize)) {
     uint16_t correctionSize = bn_ptr_shiftLeftByBits(tmp2, rootPtr, s1Size + k, 1);
@@ -792,15 +845,25 @@ static uint16_t bn_sqrt_recursive(uint8_t * nPtr, uint16_t nSize, uint8_t * root
 void bn_sqrt(bn * n, bn * root, bn * tmp0, bn * tmp1, bn * tmp2, bn * tmp3) {
   uint16_t nSize = n->used;
 
-  uint8_t shift = nlz(n->ptr[nSize - 1]);
-  if (shift > 1) {
-    bn_ptr_shiftLeftByBits(n->ptr, n->ptr, nSize, shift);
+  // n is normalized to even size with one of two highest bits set: it's shifted left by even number of bits,
+  // odd size gets zero digit below, and root is shifted back by half of that
+  uint8_t shift = nlz(n->ptr[nSize - 1]) & 0xFE;
+  if (nSize & 1) {
+    for (uint16_t i = nSize; i > 0; --i) {
+      n->ptr[i] = n->ptr[i - 1];
+    }
+    n->ptr[0] = 0;
+    ++nSize;
+    shift += 8;
+  }
+  if (shift & 0x7) {
+    bn_ptr_shiftLeftByBits(n->ptr, n->ptr, nSize, shift & 0x7);
   }
 
   bn_sqrt_recursive(n->ptr, nSize, root->ptr, tmp3->ptr, tmp0->ptr, tmp1->ptr, tmp2->ptr, tmp3->ptr);
   root->used = nSize >> 1;
 
-  if (shift > 1) {
+  if (shift) {
     root->used = bn_ptr_shiftRightByBits(root->ptr, root->ptr, root->used, shift >> 1);
   }
 };
\ No newline at end of file
@@ -3,4 +3,4 @@
 SET ZCCCFG=%Z88DK_DIR%lib\config\
 SET PATH=%Z88DK_DIR%bin;%PATH%
 
-zcc +8080 -DN=10000 pi.c bn.c ../../shared/hal.asm -m -o pi_chudnovsky_10000
+zcc +8080 -DN=10000 pi.c bn.c ../../shared/fmt.c ../../shared/ticks.c ../../shared/ticks.asm ../../shared/hal.asm -m -o pi_chudnovsky_10000
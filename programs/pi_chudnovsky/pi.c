@@ -1,6 +1,9 @@
 #include <stdint.h>
 #include <stdio.h>
 #include "bn.h"
+#include "../../shared/hal.h"
+#include "../../shared/memmap.h"
+#include "../../shared/ticks.h"
 
 #ifndef N
 #define N           100
@@ -8,41 +11,18 @@
 
 #define PRECISION   10
 
-void storeTime(uint8_t * dst) {
-  *dst = *(uint8_t *)0xF880;
-  *(dst + 1) = *(uint8_t *)0xF881;
-  *(dst + 2) = *(uint8_t *)0xF882;
-  *(dst + 3) = *(uint8_t *)0xF883;
-  *(dst + 4) = *(uint8_t *)0xF884;
-}
-
-static char hex2char[16] = {
-  '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
-};
-
-static printHex(uint8_t val) {
-  fputc_cons(hex2char[val >> 4]);
-  fputc_cons(hex2char[val & 0xF]);
-}
-
-void printTime(char * prefix, uint8_t * tm) {
-  fputs(prefix, stdout);
-  fputs(": ", stdout);
-  printHex(*(tm + 4));
-  printHex(*(tm + 3));
-  printHex(*(tm + 2));
-  printHex(*(tm + 1));
-  printHex(*tm);
-  fputs(" ticks\n", stdout);
-}
-
 // (log2(10) * decDigitsToKeep) / 8 ~ ((10/3) * decDigitsToKeep) / 8
 static uint16_t wordsForIntegerForm = ((((10 * (N + PRECISION)) / 3) / 8) + 1);
 
-// 0x0 .. 0x2FFF memory for ROM and data, 0x3000 bytes = 12Kb
-
 // numbers for N = 10_000 occupies a bit more than 4Kb, so we can reserve 5Kb (0x1400) for each variable
-// we can have 10 5Kb slots
+// we can have 10 5Kb slots in data region of memory map
+#define SLOT_SIZE   0x1400U
+#define SLOTS       10
+#define SLOT(i)     (MEM_DATA_START + (i) * SLOT_SIZE)
+
+#if MEM_DATA_START + SLOTS * SLOT_SIZE > MEM_DATA_END
+#error "big number slots don't fit data region"
+#endif
 
 /*
  For square root constant computation
@@ -58,7 +38,7 @@ static uint16_t wordsForIntegerForm = ((((10 * (N + PRECISION)) / 3) / 8) + 1);
  * 08  tmp3
  * 09  tmp3
  */
-static bn sqrtX = { .ptr = 0x3000 };
+static bn sqrtX = { .ptr = SLOT(0) };
 
 /*
  For denominator computation
@@ -74,10 +54,10 @@ static bn sqrtX = { .ptr = 0x3000 };
  * 08
  * 09
  */
-static bn aK = { .ptr = 0x4400 };
-static bn a = { .ptr = 0x5800 };
-static bn b = { .ptr = 0x6C00 };
-static bn aKMult = { .ptr = 0x8000 };
+static bn aK = { .ptr = SLOT(1) };
+static bn a = { .ptr = SLOT(2) };
+static bn b = { .ptr = SLOT(3) };
+static bn aKMult = { .ptr = SLOT(4) };
 
 /*
  For pi computation
@@ -93,27 +73,27 @@ static bn aKMult = { .ptr = 0x8000 };
  * 08  tmpDividend
  * 09
  */
-static bn denominator = { .ptr = 0x4400 };
-static bn numerator = { .ptr = 0x5800 };
-static bn pi = { .ptr = 0x8000 };
+static bn denominator = { .ptr = SLOT(1) };
+static bn numerator = { .ptr = SLOT(2) };
+static bn pi = { .ptr = SLOT(4) };
 
 // temp variables
-static bn slot0 = { .ptr = 0x3000 };
-static bn slot1 = { .ptr = 0x4400 };
-static bn slot2 = { .ptr = 0x5800 };
-static bn slot3 = { .ptr = 0x6C00 };
-static bn slot4 = { .ptr = 0x8000 };
-static bn slot5 = { .ptr = 0x9400 };
-static bn slot6 = { .ptr = 0xA800 };
-static bn slot7 = { .ptr = 0xBC00 };
-static bn slot8 = { .ptr = 0xD000 };
-static bn slot9 = { .ptr = 0xE400 };
+static bn slot0 = { .ptr = SLOT(0) };
+static bn slot1 = { .ptr = SLOT(1) };
+static bn slot2 = { .ptr = SLOT(2) };
+static bn slot3 = { .ptr = SLOT(3) };
+static bn slot4 = { .ptr = SLOT(4) };
+static bn slot5 = { .ptr = SLOT(5) };
+static bn slot6 = { .ptr = SLOT(6) };
+static bn slot7 = { .ptr = SLOT(7) };
+static bn slot8 = { .ptr = SLOT(8) };
+static bn slot9 = { .ptr = SLOT(9) };
 
 // 32 bytes each (up to 78 decimal digits)
-static bn coef = { .ptr = 0xF800 };
-static bn small0 = { .ptr = 0xF820 };
-static bn small1 = { .ptr = 0xF840 };
-static bn small2 = { .ptr = 0xF860 };
+static bn coef = { .ptr = MEM_SMALL(0) };
+static bn small0 = { .ptr = MEM_SMALL(1) };
+static bn small1 = { .ptr = MEM_SMALL(2) };
+static bn small2 = { .ptr = MEM_SMALL(3) };
 
 void computeCoef() {
   bn_fromInt(&small0, 640320);
@@ -206,23 +186,30 @@ void computePi() {
 }
 
 void printPi() {
+  uint8_t buf[CONS_BLOCK];
+  uint8_t len = 0;
   uint16_t currentDigitIdx = pi.used - 1;
   bn_fromInt(&small0, 10);
 
   for (uint16_t i = (N + 1); i > 0; --i) {
-    fputc_cons(pi.ptr[currentDigitIdx] + '0');
+    buf[len++] = pi.ptr[currentDigitIdx] + '0';
+    if (len == CONS_BLOCK) {
+      cons_write(buf, len);
+      len = 0;
+    }
     pi.ptr[currentDigitIdx] = 0x00;
     bn_mulBy10(&pi, &slot0);
   }
 
-  fputc_cons('\n');
+  buf[len++] = '\n';
+  cons_write(buf, len);
 }
 
 int main() {
-  uint8_t startTime[5], endTime[5];
+  ticks_t startTime, endTime, elapsedTime;
 
   fputc_cons(0x05);
-  storeTime(startTime);
+  ticks_snapshot(&startTime);
 
   computeSquareRootedConstant();
   computeCoef();
@@ -231,10 +218,12 @@ int main() {
   printPi();
 
   fputc_cons(0x05);
-  storeTime(endTime);
+  ticks_snapshot(&endTime);
 
-  printTime("\nStart", startTime);
-  printTime("End", endTime);
+  ticks_elapsed(&elapsedTime, &startTime, &endTime);
+  ticks_print("\nStart", &startTime);
+  ticks_print("End", &endTime);
+  ticks_print("Elapsed", &elapsedTime);
 
   return 0;
 }
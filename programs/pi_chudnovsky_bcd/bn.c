@@ -2,14 +2,24 @@
 #include <stdio.h>
 
 #include "bn.h"
+#include "../../shared/hal.h"
 
 void bn_print(bn * src) {
+  uint8_t buf[CONS_BLOCK];
+  uint8_t len = 0;
+
   for (uint16_t i = src->msd; i > 0; i--) {
-    fputc_cons('0' + src->digits[i]);
+    buf[len++] = '0' + src->digits[i];
+    // room for last digit and newline is kept
+    if (len == CONS_BLOCK - 2) {
+      cons_write(buf, len);
+      len = 0;
+    }
   }
 
-  fputc_cons('0' + src->digits[0]);
-  fputc_cons('\n');
+  buf[len++] = '0' + src->digits[0];
+  buf[len++] = '\n';
+  cons_write(buf, len);
 }
 
 void bn_zero(bn * dst) {
@@ -45,7 +55,7 @@ void bn_fromDigits(bn * dst, uint8_t * digits, uint16_t sz) {
 }
 
 void bn_powerOf10(bn * result, uint16_t power) {
-  for (uint16_t i = 0; i < power - 1; i++) {
+  for (uint16_t i = 0; i < power; i++) {
     result->digits[i] = 0;
   }
 
@@ -245,8 +255,8 @@ void bn_divmod(bn * quotient, bn * reminder, bn * dividend, bn * divisor, bn * t
     bn_clone(reminder, currReminder);
   }
 
-  // skip leading 0s for reminder
-  for (i = divisor->msd; reminder->digits[i] == 0 && i > 0; i--);
+  // skip leading 0s for reminder, digits above its msd are left from previous steps
+  for (i = reminder->msd; reminder->digits[i] == 0 && i > 0; i--);
   reminder->msd = i;
 }
 
@@ -255,7 +265,7 @@ uint8_t bn_isEqual(bn * first, bn * second) {
     return 0;
   }
 
-  for (uint16_t i = 0; i < first->msd; i++) {
+  for (uint16_t i = 0; i <= first->msd; i++) {
     if (first->digits[i] != second->digits[i]) {
       return 0;
     }
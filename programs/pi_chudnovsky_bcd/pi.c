@@ -2,65 +2,46 @@
 #include <stdio.h>
 
 #include "bn.h"
-
-void storeTime(uint8_t * dst) {
-  *dst = *(uint8_t *)0xF880;
-  *(dst + 1) = *(uint8_t *)0xF881;
-  *(dst + 2) = *(uint8_t *)0xF882;
-  *(dst + 3) = *(uint8_t *)0xF883;
-  *(dst + 4) = *(uint8_t *)0xF884;
-}
-
-static char hex2char[16] = {
-  '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
-};
-
-static printHex(uint8_t val) {
-  fputc_cons(hex2char[val >> 4]);
-  fputc_cons(hex2char[val & 0xF]);
-}
-
-void printTime(char * prefix, uint8_t * tm) {
-  fputs(prefix, stdout);
-  fputs(": ", stdout);
-  printHex(*(tm + 4));
-  printHex(*(tm + 3));
-  printHex(*(tm + 2));
-  printHex(*(tm + 1));
-  printHex(*tm);
-  fputs(" ticks\n", stdout);
-}
+#include "../../shared/hal.h"
+#include "../../shared/memmap.h"
+#include "../../shared/ticks.h"
 
 #define N           1000
 #define PRECISION   10
 
-// 0x0 .. 0x2FFF memory for ROM and data, 0x3000 bytes = 12Kb
+// 10240 bytes each (5 slots in data region of memory map)
+#define SLOT_SIZE   0x2800U
+#define SLOTS       5
+#define SLOT(i)     (MEM_DATA_START + (i) * SLOT_SIZE)
 
-// 10240 bytes each (5 slots)
-static bn * denominator = (bn *)0x3000;
-static bn * a = (bn *)0x3000;
-static bn * sqrtNextX = (bn *)0x3000;
+#if MEM_DATA_START + SLOTS * SLOT_SIZE > MEM_DATA_END
+#error "big number slots don't fit data region"
+#endif
 
-static bn * pi = (bn *)0x5800;
-static bn * numerator = (bn *)0x5800;
-static bn * aK = (bn *)0x5800;
-static bn * t2 = (bn *)0x5800;
+static bn * denominator = (bn *)SLOT(0);
+static bn * a = (bn *)SLOT(0);
+static bn * sqrtNextX = (bn *)SLOT(0);
 
-static bn * b = (bn *)0x8000;
-static bn * t1 = (bn *)0x8000;
+static bn * pi = (bn *)SLOT(1);
+static bn * numerator = (bn *)SLOT(1);
+static bn * aK = (bn *)SLOT(1);
+static bn * t2 = (bn *)SLOT(1);
 
-static bn * t0 = (bn *)0xA800;
+static bn * b = (bn *)SLOT(2);
+static bn * t1 = (bn *)SLOT(2);
 
-static bn * sqrtX = (bn *)0xD000;
-static bn * t3 = (bn *)0xD000;
+static bn * t0 = (bn *)SLOT(3);
+
+static bn * sqrtX = (bn *)SLOT(4);
+static bn * t3 = (bn *)SLOT(4);
 
 // 32 bytes each
-static bn * coef = (bn *)0xF800;
-static bn * small0 = (bn *)0xF820;
-static bn * small1 = (bn *)0xF840;
-static bn * small2 = (bn *)0xF860;
-// 0xF880 reserved for tick counter
-static bn * small3 = (bn *)0xF8A0;
+static bn * coef = (bn *)MEM_SMALL(0);
+static bn * small0 = (bn *)MEM_SMALL(1);
+static bn * small1 = (bn *)MEM_SMALL(2);
+static bn * small2 = (bn *)MEM_SMALL(3);
+// MEM_SMALL(4) is tick counter
+static bn * small3 = (bn *)MEM_SMALL(5);
 
 // literal constants
 static uint8_t c1[6] = { 6, 4, 0, 3, 2, 0 };
@@ -175,25 +156,34 @@ void computePi() {
 
 int main()
 {
-  uint8_t startTime[5], endTime[5];
+  ticks_t startTime, endTime, elapsedTime;
+  uint8_t buf[CONS_BLOCK];
+  uint8_t len = 0;
 
   fputc_cons(0x05);
-  storeTime(startTime);
+  ticks_snapshot(&startTime);
 
   computeSquareRootedConstant();
   computeDenominator();
   computePi();
 
-  fputc_cons('\n');
+  buf[len++] = '\n';
   for (uint16_t i = pi->msd; i > PRECISION - 1; i--) {
-    fputc_cons('0' + pi->digits[i]);
+    buf[len++] = '0' + pi->digits[i];
+    if (len == CONS_BLOCK) {
+      cons_write(buf, len);
+      len = 0;
+    }
   }
+  cons_write(buf, len);
 
   fputc_cons(0x05);
-  storeTime(endTime);
+  ticks_snapshot(&endTime);
 
-  printTime("\nStart", startTime);
-  printTime("End", endTime);
+  ticks_elapsed(&elapsedTime, &startTime, &endTime);
+  ticks_print("\nStart", &startTime);
+  ticks_print("End", &endTime);
+  ticks_print("Elapsed", &elapsedTime);
 
   return 0;
 }
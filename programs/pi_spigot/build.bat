@@ -3,4 +3,5 @@
 SET ZCCCFG=%Z88DK_DIR%lib\config\
 SET PATH=%Z88DK_DIR%bin;%PATH%
 
-zcc +8080 pi.c ../../shared/hal.asm -m -o pi_spigot_2048
\ No newline at end of file
+zcc +8080 -DN=2048 pi.c ../../shared/arith.asm ../../shared/fmt.c ../../shared/ticks.c ../../shared/ticks.asm ../../shared/hal.asm -m -o pi_spigot_2048
+zcc +8080 -DN=2048 -DBASE10000 pi.c ../../shared/arith.asm ../../shared/fmt.c ../../shared/ticks.c ../../shared/ticks.asm ../../shared/hal.asm -m -o pi_spigot_base10000_2048
\ No newline at end of file
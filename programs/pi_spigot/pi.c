@@ -1,48 +1,86 @@
 #include <stdio.h>
 #include <stdint.h>
+#include "../../shared/arith.h"
+#include "../../shared/hal.h"
+#include "../../shared/memmap.h"
+#include "../../shared/ticks.h"
 
-#define MEM_START 0x4000
-#define N 2048
+#ifndef N
+#define N                 2048
+#endif
 
-void storeTime(uint8_t * dst) {
-  *dst = *(uint8_t *)0xF880;
-  *(dst + 1) = *(uint8_t *)0xF881;
-  *(dst + 2) = *(uint8_t *)0xF882;
-  *(dst + 3) = *(uint8_t *)0xF883;
-  *(dst + 4) = *(uint8_t *)0xF884;
-}
+// amount of 16-bit cells in A[]
+#define LEN               (((10L * N) / 3) + 1)
+
+// PACKED layout places A[] right after ROM image, that allows N up to 7699, default layout allows N up to 7084
+#ifdef PACKED
+#define MEM_START         MEM_SPIGOT_PACKED
+#else
+#define MEM_START         MEM_SPIGOT_START
+#endif
+
+#define MEM_END           MEM_SPIGOT_END
+
+#if (MEM_START + 2 * LEN) > MEM_END
+#error "A[] overlaps with tick counter, decrease N or use PACKED layout"
+#endif
 
-static char hex2char[16] = {
-  '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
-};
+// BASE10000 variant multiplies by 10000 and emits 4 digits per sweep over A[], instead of 1
+#ifdef BASE10000
+#define BASE              10000
+#define DIGITS_PER_SWEEP  4
+#else
+#define BASE              10
+#define DIGITS_PER_SWEEP  1
+#endif
 
-static printHex(uint8_t val) {
-  fputc_cons(hex2char[val >> 4]);
-  fputc_cons(hex2char[val & 0xF]);
+// retired cells are still processed with such lag, otherwise truncation error breaks last digits
+#define GUARD_CELLS       20
+
+static uint16_t printed = 0;
+
+// digits wait here until CONS_BLOCK of them are collected, so cons_write() is called once per block
+static uint8_t out[CONS_BLOCK];
+static uint8_t outLen = 0;
+
+void flushDigits() {
+  cons_write(out, outLen);
+  outLen = 0;
 }
 
-void printTime(char * prefix, uint8_t * tm) {
-  fputs(prefix, stdout);
-  fputs(": ", stdout);
-  printHex(*(tm + 4));
-  printHex(*(tm + 3));
-  printHex(*(tm + 2));
-  printHex(*(tm + 1));
-  printHex(*tm);
-  fputs(" ticks\n", stdout);
+// adds block as zero-padded number with given amount of digits, but never more than N digits in total
+void printBlock(uint16_t block, uint8_t digits) {
+  char buf[DIGITS_PER_SWEEP];
+
+  for (uint8_t i = digits; i > 0; i--) {
+    buf[i - 1] = '0' + block % 10;
+    block = block / 10;
+  }
+
+  if (digits > N - printed) {
+    digits = N - printed;
+  }
+  for (uint8_t i = 0; i < digits; i++) {
+    out[outLen++] = buf[i];
+    if (outLen == CONS_BLOCK) {
+      flushDigits();
+    }
+  }
+  printed += digits;
 }
 
 int main()
 {
-  uint8_t startTime[5], endTime[5];
-  uint16_t len = ((10 * N) / 3) + 1;
+  ticks_t startTime, endTime, elapsedTime;
+  uint16_t len = LEN;
   uint16_t * A = (uint16_t *)MEM_START;
-  uint16_t printed = 0;
   uint8_t nineCount = 0;
-  uint8_t previousDigit = 2;
+  uint16_t previousBlock = 2;
+  uint16_t retired = 0;
+  uint8_t retiredFraction = 0;
 
   fputc_cons(0x05);
-  storeTime(startTime);
+  ticks_snapshot(&startTime);
   for(uint16_t i = 0; i < len; i++) {
     A[i] = 2;
   }
@@ -50,40 +88,53 @@ int main()
   while (printed < N) {
     uint32_t carry = 0;
 
-    uint16_t denominator = len - 1, numerator = (2 * len - 1), idx = 0;
+    uint16_t idx = retired > GUARD_CELLS ? retired - GUARD_CELLS : 0;
+    uint16_t denominator = len - 1 - idx, numerator = (2 * denominator + 1);
     while (denominator > 0) {
-      uint32_t x = ((uint32_t)A[idx]) * 10L + carry;
-      carry = denominator * (x / numerator);
-      A[idx] = x % numerator;
+      // quotient always fits 16 bits, so single 32/16 division gives both quotient and remainder;
+      // helpers take 3620 cycles per cell, library l_long_mult and l_long_div_u took 29872 (N=2048)
+      uint32_t x = umul16x16(A[idx], BASE) + carry;
+      carry = umul16x16(denominator, udivmod32by16(x, numerator, &A[idx]));
       denominator--;
       numerator -= 2;
       idx++;
     }
 
-    uint8_t digitFromCarry = carry < 10 ? 0 : 1;
-    uint8_t nextDigit = carry < 10 ? carry : ((uint8_t)carry - 10);
-    if (nextDigit == 9) {
+    // each produced digit needs ~10/3 cells, cells at the start of A[] hold tail of the series,
+    // which can't affect remaining digits anymore, so they are retired from next sweeps
+    retired += (10 * DIGITS_PER_SWEEP) / 3;
+    retiredFraction += (10 * DIGITS_PER_SWEEP) % 3;
+    if (retiredFraction >= 3) {
+      retiredFraction -= 3;
+      retired++;
+    }
+
+    // block which is equal to BASE - 1 (single 9 or 9999) could be changed by carry, so keep it until next one
+    uint8_t blockFromCarry = carry < BASE ? 0 : 1;
+    uint16_t nextBlock = carry < BASE ? carry : ((uint16_t)carry - BASE);
+    if (nextBlock == BASE - 1) {
       nineCount++;
       continue;
     }
 
-    uint8_t currentDigit = previousDigit + digitFromCarry;
-    fputc_cons(currentDigit + '0');
-    previousDigit = nextDigit;
-    printed++;
+    // integer part of pi is single digit, so first block is not padded
+    printBlock(previousBlock + blockFromCarry, printed == 0 ? 1 : DIGITS_PER_SWEEP);
+    previousBlock = nextBlock;
 
     for (uint8_t i = 0; i < nineCount; i++) {
-      fputc_cons(digitFromCarry == 0 ? '9' : '0');
-      printed++;
+      printBlock(blockFromCarry == 0 ? BASE - 1 : 0, DIGITS_PER_SWEEP);
     }
     nineCount = 0;
   }
+  flushDigits();
 
   fputc_cons(0x05);
-  storeTime(endTime);
+  ticks_snapshot(&endTime);
 
-  printTime("\nStart", startTime);
-  printTime("End", endTime);
+  ticks_elapsed(&elapsedTime, &startTime, &endTime);
+  ticks_print("\nStart", &startTime);
+  ticks_print("End", &endTime);
+  ticks_print("Elapsed", &elapsedTime);
 
   return 0;
 }
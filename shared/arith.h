@@ -0,0 +1,12 @@
+#ifndef __ARITH_H__
+#define __ARITH_H__
+
+#include <stdint.h>
+
+// quotient should fit 16 bits, so high word of dividend should be less than divisor
+uint16_t udivmod32by16(uint32_t dividend, uint16_t divisor, uint16_t * remainder);
+
+uint32_t umul16x16(uint16_t factor1, uint16_t factor2);
+int32_t smul16x16(int16_t factor1, int16_t factor2);
+
+#endif
@@ -0,0 +1,131 @@
+#include <stdint.h>
+
+#include "fmt.h"
+
+static char hex2char[16] = {
+  '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+// lowercase is 0x20 for %x, ORed into letters only, minus sign goes before zero padding, but after space padding
+static void printNumber(uint32_t value, uint8_t base, uint8_t lowercase, uint8_t negative, char pad, uint8_t width) {
+  // digits are stored from the end, so they can be written as one block
+  char buf[11];
+  uint8_t pos = sizeof(buf);
+  char c;
+
+  // 16-bit values, which are most of printed ones, avoid 32-bit division
+  if (value <= 0xFFFF) {
+    uint16_t small = value;
+    do {
+      c = hex2char[small % base];
+      buf[--pos] = c > '9' ? c | lowercase : c;
+      small = small / base;
+    } while (small);
+  } else {
+    do {
+      c = hex2char[value % base];
+      buf[--pos] = c > '9' ? c | lowercase : c;
+      value = value / base;
+    } while (value);
+  }
+
+  if (negative) {
+    if (pad == '0') {
+      fputc_cons_native('-');
+      if (width > 0) {
+        width--;
+      }
+    } else {
+      buf[--pos] = '-';
+    }
+  }
+
+  for (uint8_t len = sizeof(buf) - pos; width > len; width--) {
+    fputc_cons_native(pad);
+  }
+
+  cons_write((const uint8_t *)buf + pos, sizeof(buf) - pos);
+}
+
+void fmt_printf(const char * format, ...) __stdc {
+  // arguments are pushed from right to left, so they follow format on stack, chars are promoted to 16 bits
+  uint8_t * arg = (uint8_t *)&format + sizeof(format);
+  char c;
+
+  while (1) {
+    // literal text up to next conversion is written as one block
+    const char * text = format;
+    while (*format != 0 && *format != '%') {
+      format++;
+    }
+    if (format != text) {
+      cons_write((const uint8_t *)text, format - text);
+    }
+    if (*format++ == 0) {
+      break;
+    }
+
+    char pad = ' ';
+    uint8_t width = 0;
+    uint8_t isLong = 0;
+
+    c = *format++;
+    if (c == '0') {
+      pad = '0';
+      c = *format++;
+    }
+    while (c >= '0' && c <= '9') {
+      width = width * 10 + (c - '0');
+      c = *format++;
+    }
+    if (c == 'l') {
+      isLong = 1;
+      c = *format++;
+    }
+
+    if (c == 0) {
+      break;
+    }
+
+    if (c == 'c') {
+      fputc_cons_native(*(char *)arg);
+      arg += sizeof(int);
+    } else if (c == 's') {
+      char * str = *(char **)arg;
+      arg += sizeof(char *);
+      const char * end = str;
+      while (*end) {
+        end++;
+      }
+      cons_write((const uint8_t *)str, end - str);
+    } else if (c == 'd' || c == 'u' || c == 'x' || c == 'X') {
+      uint32_t value;
+      if (isLong) {
+        value = *(uint32_t *)arg;
+        arg += sizeof(uint32_t);
+      } else {
+        value = c == 'd' ? (uint32_t)(int32_t)*(int16_t *)arg : *(uint16_t *)arg;
+        arg += sizeof(int);
+      }
+
+      uint8_t negative = c == 'd' && (int32_t)value < 0;
+      if (negative) {
+        value = -value;
+      }
+
+      printNumber(value, c == 'd' || c == 'u' ? 10 : 16, c == 'x' ? 0x20 : 0, negative, pad, width);
+    } else {
+      fputc_cons_native(c);
+    }
+  }
+}
+
+void fmt_seconds(uint32_t ticks, uint32_t ticksPerSecond) {
+  uint32_t seconds = ticks / ticksPerSecond;
+  // remainder * 1000 fits 32 bits while ticksPerSecond is below 4294967
+  uint16_t millis = (ticks - seconds * ticksPerSecond) * 1000 / ticksPerSecond;
+
+  printNumber(seconds, 10, 0, 0, ' ', 0);
+  fputc_cons_native('.');
+  printNumber(millis, 10, 0, 0, '0', 3);
+}
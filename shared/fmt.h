@@ -0,0 +1,15 @@
+#ifndef __FMT_H__
+#define __FMT_H__
+
+#include <stdint.h>
+
+#include "hal.h"
+
+// minimal printf replacement writing through cons_write and fputc_cons_native, no float support
+// conversions: %c %s %d %u %x %X and %% with optional '0' flag, width and 'l' modifier, e.g. %02X, %04x, %lu
+void fmt_printf(const char * format, ...) __stdc;
+
+// prints ticks / ticksPerSecond as seconds with 3 decimals ("12.345"), fraction is truncated
+void fmt_seconds(uint32_t ticks, uint32_t ticksPerSecond);
+
+#endif
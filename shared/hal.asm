@@ -3,20 +3,259 @@ SECTION code_user
 PUBLIC fputc_cons_native
 PUBLIC _fputc_cons_native
 
+PUBLIC cons_write
+PUBLIC _cons_write
+
+PUBLIC cons_flush
+PUBLIC _cons_flush
+
 PUBLIC fgetc_cons
 PUBLIC _fgetc_cons
 
+; with CONS_FIFO defined (zcc -Ca-DCONS_FIFO) output is queued and sent by interrupt handler,
+; which replaces library asm_im1_handler called from RST 38h, so transmitter should raise
+; interrupt when it is ready for the next byte
+;
+; measured in sbcemu --tx-irq: queueing takes 189 cycles per byte in fputc_cons_native (252 in cons_write),
+; handler takes 210 per byte it sends, while plain path takes 47 (30 in cons_write) plus stall of OUT,
+; so queue pays off when OUT stalls more than 352 cycles per byte (432 with cons_write), --out-wait 1:N
+IFDEF CONS_FIFO
+PUBLIC asm_im1_handler
+ENDIF
 
 fputc_cons_native:
 _fputc_cons_native:
-    pop     bc  ;return address
-    pop     hl  ;character to print in l
+    ld      hl,2
+    add     hl,sp
+    ld      a,(hl)          ;character to print
+IFDEF CONS_FIFO
+    jp      fifo_put
+ELSE
+    out     (1),a
+    ret
+ENDIF
+
+; void cons_write(const uint8_t * buf, uint16_t len)
+;
+; loop outputs 8 bytes per iteration, first iteration is entered in the middle to output len % 8 bytes,
+; with CONS_FIFO bytes are queued one by one
+IFDEF CONS_FIFO
+cons_write:
+_cons_write:
+    ld      hl,2
+    add     hl,sp
+    ld      c,(hl)          ;len
+    inc     hl
+    ld      b,(hl)
+    inc     hl
+    ld      a,(hl)          ;buf
+    inc     hl
+    ld      h,(hl)
+    ld      l,a
+
+cons_write_next:
+    ld      a,b
+    or      c
+    ret     z
+    ld      a,(hl)
+    inc     hl
+    dec     bc
     push    hl
     push    bc
-    ld      a,l
+    call    fifo_put
+    pop     bc
+    pop     hl
+    jp      cons_write_next
+ELSE
+cons_write:
+_cons_write:
+    ld      hl,2
+    add     hl,sp
+    ld      c,(hl)          ;len
+    inc     hl
+    ld      b,(hl)
+    inc     hl
+    ld      a,(hl)          ;buf
+    inc     hl
+    ld      h,(hl)
+    ld      l,a
+
+    ld      a,b
+    or      c
+    ret     z
+    push    hl
+
+    ; each output is 4 bytes of code, so entry point is cons_write_loop + 4 * (-len & 7)
+    ld      a,c
+    cpl
+    inc     a
+    and     7
+    add     a,a
+    add     a,a
+    ld      hl,cons_write_loop
+    add     a,l
+    ld      l,a
+    ld      a,h
+    adc     a,0
+    ld      h,a
+    ex      (sp),hl         ;hl = buf, entry point is on stack
+
+    ; bc = (len + 7) / 8, carry from high byte is shifted back in
+    ld      a,c
+    add     a,7
+    ld      c,a
+    ld      a,b
+    adc     a,0
+    rra
+    ld      b,a
+    ld      a,c
+    rra
+    ld      c,a
+    ld      a,b
+    or      a
+    rra
+    ld      b,a
+    ld      a,c
+    rra
+    ld      c,a
+    ld      a,b
+    or      a
+    rra
+    ld      b,a
+    ld      a,c
+    rra
+    ld      c,a
+    ret                     ;jump to entry point
+
+cons_write_loop:
+    ld      a,(hl)
+    out     (1),a
+    inc     hl
+    ld      a,(hl)
+    out     (1),a
+    inc     hl
+    ld      a,(hl)
+    out     (1),a
+    inc     hl
+    ld      a,(hl)
+    out     (1),a
+    inc     hl
+    ld      a,(hl)
+    out     (1),a
+    inc     hl
+    ld      a,(hl)
+    out     (1),a
+    inc     hl
+    ld      a,(hl)
+    out     (1),a
+    inc     hl
+    ld      a,(hl)
     out     (1),a
+    inc     hl
+    dec     bc
+    ld      a,b
+    or      c
+    jp      nz,cons_write_loop
+    ret
+ENDIF
+
+; void cons_flush()
+;
+; waits until queued output is sent, does nothing without CONS_FIFO
+cons_flush:
+_cons_flush:
+IFDEF CONS_FIFO
+    ld      a,(fifo_busy)
+    or      a
+    jp      nz,cons_flush
+ENDIF
     ret
 
 fgetc_cons:
 _fgetc_cons:
     ret
+
+IFDEF CONS_FIFO
+; a = byte to send, bc, de and hl are not preserved
+;
+; queue is 256 bytes with 8-bit head and tail, so indexes wrap by themselves, head + 1 == tail means full
+fifo_put:
+    ld      e,a
+    di
+    ld      a,(fifo_busy)
+    or      a
+    jp      nz,fifo_put_queue
+
+    ; transmitter is idle, so byte is sent right away and interrupt will ask for the next one
+    inc     a
+    ld      (fifo_busy),a
+    ld      a,e
+    out     (1),a
+    ei
+    ret
+
+fifo_put_queue:
+    ld      a,(fifo_tail)
+    ld      d,a
+    ld      a,(fifo_head)
+    ld      c,a
+    inc     a
+    cp      d
+    jp      z,fifo_put_full
+    ld      (fifo_head),a
+    ld      b,0
+    ld      hl,fifo_buf
+    add     hl,bc
+    ld      (hl),e
+    ei
+    ret
+
+fifo_put_full:
+    ; interrupt is accepted after instruction that follows ei, so handler gets a chance to free a slot
+    ei
+    ld      a,e
+    jp      fifo_put
+
+; transmitter is ready, next byte is sent, if queue is empty, then handler returns with interrupts
+; disabled, so level-triggered interrupt doesn't repeat, fifo_put sends next byte directly
+asm_im1_handler:
+    push    af
+    push    hl
+    ld      a,(fifo_tail)
+    ld      hl,fifo_head
+    cp      (hl)
+    jp      z,fifo_empty
+    push    de
+    ld      e,a
+    ld      d,0
+    ld      hl,fifo_buf
+    add     hl,de
+    ld      a,(hl)
+    out     (1),a
+    ld      a,e
+    inc     a
+    ld      (fifo_tail),a
+    pop     de
+    pop     hl
+    pop     af
+    ei
+    ret
+
+fifo_empty:
+    xor     a
+    ld      (fifo_busy),a
+    pop     hl
+    pop     af
+    ret
+
+SECTION bss_user
+
+fifo_busy:
+    defs    1
+fifo_head:
+    defs    1
+fifo_tail:
+    defs    1
+fifo_buf:
+    defs    256
+ENDIF
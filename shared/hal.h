@@ -0,0 +1,18 @@
+#ifndef __HAL_H__
+#define __HAL_H__
+
+#include <stdint.h>
+
+// digit loops collect output in local buffers of such size and flush them with cons_write()
+#define CONS_BLOCK        32
+
+// writes single character to console port
+int fputc_cons_native(char c);
+
+// writes len bytes from buf to console port with unrolled loop, much cheaper than len calls of fputc_cons
+void cons_write(const uint8_t * buf, uint16_t len);
+
+// waits until output queued by CONS_FIFO build of hal.asm is sent, does nothing otherwise
+void cons_flush(void);
+
+#endif
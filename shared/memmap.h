@@ -0,0 +1,68 @@
+#ifndef __MEMMAP_H__
+#define __MEMMAP_H__
+
+// memory map of i8080-sbc, memmap.inc has the same values for asm code and 8080_crt.asm
+//
+// 0x0000 .. 0x2FFF  ROM image: code, data and BSS (12Kb), images of programs that keep nothing in data
+//                   region (CoreMark) may grow up to 0xF7FF, they are built with
+//                   -pragma-define:CRT_NO_DATA_REGION=1
+// 0x3000 .. 0xF7FF  program data, big numbers
+// 0xF800 .. 0xF8BF  32-byte slots for small numbers, slot at 0xF880 is taken by tick counter
+// 0xF8C0 .. 0xFFFF  stack, SP starts at 0x0000, so first push wraps to 0xFFFF
+
+#define MEM_CODE_START        0x0000
+#define MEM_CODE_END          0x3000
+
+#define MEM_DATA_START        0x3000
+#define MEM_DATA_END          0xF800
+
+#define MEM_SMALL_START       0xF800
+#define MEM_SMALL_END         0xF8C0
+#define MEM_SMALL_SIZE        0x20
+#define MEM_SMALL(i)          (MEM_SMALL_START + (i) * MEM_SMALL_SIZE)
+
+// 40-bit tick counter, incremented by hardware
+#define MEM_TICKS             0xF880
+#define MEM_TICKS_SIZE        5
+
+#define MEM_STACK_LIMIT       0xF8C0
+#define MEM_STACK_TOP         0x0000
+
+// pi_spigot A[], PACKED layout starts right after ROM image, A[] may use small slots below tick counter
+#define MEM_SPIGOT_START      0x4000
+#define MEM_SPIGOT_PACKED     MEM_DATA_START
+#define MEM_SPIGOT_END        MEM_TICKS
+
+// Dhrystone records pointed by Next_Ptr_Glob and Ptr_Glob
+#define MEM_DHRY_NEXT_REC     0x8000
+#define MEM_DHRY_REC          0xA000
+#define MEM_DHRY_REC_SIZE     0x2000
+
+// checks below compare constants only, end of linked image (__BSS_END_tail of .map file) is checked
+// against __IMAGE_END exported by 8080_crt.asm when sbcemu or sbcbench load it
+
+#if MEM_CODE_END > MEM_DATA_START
+#error "memmap: ROM image overlaps data region"
+#endif
+
+#if MEM_DATA_END > MEM_SMALL_START
+#error "memmap: data region overlaps small number slots"
+#endif
+
+#if MEM_TICKS < MEM_SMALL_START || MEM_TICKS + MEM_TICKS_SIZE > MEM_SMALL_END || (MEM_TICKS - MEM_SMALL_START) % MEM_SMALL_SIZE != 0
+#error "memmap: tick counter should take one of small number slots"
+#endif
+
+#if MEM_SMALL_END > MEM_STACK_LIMIT
+#error "memmap: small number slots overlap stack"
+#endif
+
+#if MEM_SPIGOT_PACKED < MEM_CODE_END || MEM_SPIGOT_START < MEM_CODE_END || MEM_SPIGOT_END > MEM_TICKS
+#error "memmap: pi_spigot data is outside of free memory"
+#endif
+
+#if MEM_DHRY_NEXT_REC < MEM_DATA_START || MEM_DHRY_NEXT_REC + MEM_DHRY_REC_SIZE > MEM_DHRY_REC || MEM_DHRY_REC + MEM_DHRY_REC_SIZE > MEM_DATA_END
+#error "memmap: Dhrystone records overlap each other or are outside of data region"
+#endif
+
+#endif
@@ -0,0 +1,221 @@
+; Dhrystone in sbcemu, 2000 runs: 113.9 -> 114.2 Dhrystones/sec (0.0648 -> 0.0650 DMIPS), per call memcpy 1426 -> 1321, strcpy 1287 -> 1267, strcmp 1041 -> 1043 cycles
+
+SECTION code_user
+
+PUBLIC fast_memcpy
+PUBLIC _fast_memcpy
+
+PUBLIC fast_strcpy
+PUBLIC _fast_strcpy
+
+PUBLIC fast_strcmp
+PUBLIC _fast_strcmp
+
+; void * fast_memcpy(void * dst, void * src, uint16_t n)
+;
+; loop copies 8 bytes per iteration, first iteration is entered in the middle to copy n % 8 bytes
+fast_memcpy:
+_fast_memcpy:
+    ld      hl,2
+    add     hl,sp
+    ld      c,(hl)          ;n
+    inc     hl
+    ld      b,(hl)
+    inc     hl
+    ld      e,(hl)          ;src
+    inc     hl
+    ld      d,(hl)
+    inc     hl
+    ld      a,(hl)          ;dst
+    inc     hl
+    ld      h,(hl)
+    ld      l,a
+
+    ld      a,b
+    or      c
+    ret     z
+    push    hl              ;dst is returned
+
+    ex      de,hl
+    push    hl
+
+    ; each copy is 4 bytes of code, so entry point is memcpy_loop + 4 * (-n & 7)
+    ld      a,c
+    cpl
+    inc     a
+    and     7
+    add     a,a
+    add     a,a
+    ld      hl,memcpy_loop
+    add     a,l
+    ld      l,a
+    ld      a,h
+    adc     a,0
+    ld      h,a
+    ex      (sp),hl         ;hl = src, entry point is on stack
+
+    ; bc = (n + 7) / 8, carry from high byte is shifted back in
+    ld      a,c
+    add     a,7
+    ld      c,a
+    ld      a,b
+    adc     a,0
+    rra
+    ld      b,a
+    ld      a,c
+    rra
+    ld      c,a
+    ld      a,b
+    or      a
+    rra
+    ld      b,a
+    ld      a,c
+    rra
+    ld      c,a
+    ld      a,b
+    or      a
+    rra
+    ld      b,a
+    ld      a,c
+    rra
+    ld      c,a
+    ret                     ;jump to entry point
+
+memcpy_loop:
+    ld      a,(hl)
+    ld      (de),a
+    inc     hl
+    inc     de
+    ld      a,(hl)
+    ld      (de),a
+    inc     hl
+    inc     de
+    ld      a,(hl)
+    ld      (de),a
+    inc     hl
+    inc     de
+    ld      a,(hl)
+    ld      (de),a
+    inc     hl
+    inc     de
+    ld      a,(hl)
+    ld      (de),a
+    inc     hl
+    inc     de
+    ld      a,(hl)
+    ld      (de),a
+    inc     hl
+    inc     de
+    ld      a,(hl)
+    ld      (de),a
+    inc     hl
+    inc     de
+    ld      a,(hl)
+    ld      (de),a
+    inc     hl
+    inc     de
+    dec     bc
+    ld      a,b
+    or      c
+    jp      nz,memcpy_loop
+    pop     hl
+    ret
+
+; char * fast_strcpy(char * dst, char * src)
+fast_strcpy:
+_fast_strcpy:
+    ld      hl,2
+    add     hl,sp
+    ld      e,(hl)          ;src
+    inc     hl
+    ld      d,(hl)
+    inc     hl
+    ld      a,(hl)          ;dst
+    inc     hl
+    ld      h,(hl)
+    ld      l,a
+    push    hl              ;dst is returned
+
+strcpy_loop:
+    ld      a,(de)
+    ld      (hl),a
+    or      a
+    jp      z,strcpy_done
+    inc     de
+    inc     hl
+    ld      a,(de)
+    ld      (hl),a
+    or      a
+    jp      z,strcpy_done
+    inc     de
+    inc     hl
+    ld      a,(de)
+    ld      (hl),a
+    or      a
+    jp      z,strcpy_done
+    inc     de
+    inc     hl
+    ld      a,(de)
+    ld      (hl),a
+    inc     de
+    inc     hl
+    or      a
+    jp      nz,strcpy_loop
+strcpy_done:
+    pop     hl
+    ret
+
+; int fast_strcmp(char * s1, char * s2)
+;
+; returns -1, 0 or 1, characters are compared as unsigned
+fast_strcmp:
+_fast_strcmp:
+    ld      hl,2
+    add     hl,sp
+    ld      e,(hl)          ;s2
+    inc     hl
+    ld      d,(hl)
+    inc     hl
+    ld      a,(hl)          ;s1
+    inc     hl
+    ld      h,(hl)
+    ld      l,a
+    ex      de,hl           ;de = s1, hl = s2
+
+strcmp_loop:
+    ld      a,(de)
+    cp      (hl)
+    jp      nz,strcmp_differ
+    or      a
+    jp      z,strcmp_equal
+    inc     de
+    inc     hl
+    ld      a,(de)
+    cp      (hl)
+    jp      nz,strcmp_differ
+    or      a
+    jp      z,strcmp_equal
+    inc     de
+    inc     hl
+    ld      a,(de)
+    cp      (hl)
+    jp      nz,strcmp_differ
+    or      a
+    jp      z,strcmp_equal
+    inc     de
+    inc     hl
+    ld      a,(de)
+    cp      (hl)
+    jp      nz,strcmp_differ
+    inc     de
+    inc     hl
+    or      a
+    jp      nz,strcmp_loop
+strcmp_equal:
+    ld      hl,0
+    ret
+strcmp_differ:
+    ld      hl,1
+    ret     nc
+    ld      hl,-1
+    ret
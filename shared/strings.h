@@ -0,0 +1,14 @@
+#ifndef __STRINGS_H__
+#define __STRINGS_H__
+
+#include <stdint.h>
+
+// memcpy, strcpy and strcmp with unrolled loops and pointers kept in registers,
+// named differently, so they don't clash with library ones
+void * fast_memcpy(void * dst, void * src, uint16_t n);
+char * fast_strcpy(char * dst, char * src);
+
+// returns -1, 0 or 1
+int fast_strcmp(char * s1, char * s2);
+
+#endif
@@ -0,0 +1,46 @@
+SECTION code_user
+
+PUBLIC ticks_snapshot
+PUBLIC _ticks_snapshot
+
+    INCLUDE "memmap.inc"
+
+    defc    TICKS_ADDR = MEM_TICKS
+
+; void ticks_snapshot(ticks_t * dst) __z88dk_fastcall
+;
+; counter keeps running while it is read byte by byte, so bytes 1..4 are read before and after lowest one,
+; if any of them has changed, then carry happened in between and read is repeated
+ticks_snapshot:
+_ticks_snapshot:
+    ld      a,(TICKS_ADDR + 4)
+    ld      e,a
+    ld      a,(TICKS_ADDR + 3)
+    ld      d,a
+    ld      a,(TICKS_ADDR + 2)
+    ld      c,a
+    ld      a,(TICKS_ADDR + 1)
+    ld      b,a
+    ld      a,(TICKS_ADDR)
+    ld      (hl),a
+    ld      a,(TICKS_ADDR + 1)
+    cp      b
+    jp      nz,ticks_snapshot
+    ld      a,(TICKS_ADDR + 2)
+    cp      c
+    jp      nz,ticks_snapshot
+    ld      a,(TICKS_ADDR + 3)
+    cp      d
+    jp      nz,ticks_snapshot
+    ld      a,(TICKS_ADDR + 4)
+    cp      e
+    jp      nz,ticks_snapshot
+    inc     hl
+    ld      (hl),b
+    inc     hl
+    ld      (hl),c
+    inc     hl
+    ld      (hl),d
+    inc     hl
+    ld      (hl),e
+    ret
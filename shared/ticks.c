@@ -0,0 +1,46 @@
+#include <stdint.h>
+
+#include "fmt.h"
+#include "ticks.h"
+
+void ticks_elapsed(ticks_t * result, ticks_t * start, ticks_t * end) {
+  uint8_t borrow = 0;
+
+  // counter wraps after 2^40 ticks, so borrow from highest byte is dropped
+  for (uint8_t i = 0; i < 5; ++i) {
+    uint16_t digit = (uint16_t)end->b[i] + 0x100 - start->b[i] - borrow;
+    result->b[i] = digit & 0xFF;
+    borrow = digit < 0x100;
+  }
+
+  uint16_t overhead = TICKS_OVERHEAD;
+  borrow = 0;
+  for (uint8_t i = 0; i < 5; ++i) {
+    uint16_t digit = (uint16_t)result->b[i] + 0x100 - (overhead & 0xFF) - borrow;
+    result->b[i] = digit & 0xFF;
+    borrow = digit < 0x100;
+    overhead = overhead >> 8;
+  }
+
+  if (borrow) {
+    for (uint8_t i = 0; i < 5; ++i) {
+      result->b[i] = 0;
+    }
+  }
+}
+
+uint32_t ticks_toU32(ticks_t * src, uint8_t shift) {
+  uint32_t low = *(uint32_t *)src->b;
+  uint8_t high = src->b[4];
+
+  for (; shift > 0; --shift) {
+    low = (low >> 1) | ((uint32_t)(high & 1) << 31);
+    high = high >> 1;
+  }
+
+  return high ? 0xFFFFFFFF : low;
+}
+
+void ticks_print(char * prefix, ticks_t * src) {
+  fmt_printf("%s: %02X%02X%02X%02X%02X ticks\n", prefix, src->b[4], src->b[3], src->b[2], src->b[1], src->b[0]);
+}
@@ -0,0 +1,36 @@
+#ifndef __TICKS_H__
+#define __TICKS_H__
+
+#include <stdint.h>
+
+#include "memmap.h"
+
+// tick counter is incremented on every CPU cycle, same value as in 8080_crt.asm
+#ifndef __CPU_CLOCK
+#define __CPU_CLOCK       3125000L
+#endif
+
+// ticks between lowest byte reads of two back-to-back ticks_snapshot() calls with ticks_t on stack (285 for static one),
+// ticks_elapsed() subtracts it, so empty measured region gives 0; measured in sbcemu (datasheet cycles, no wait
+// states) as difference of two snapshots taken by ticks.asm called the way sccz80 calls it, "ld hl,n / add hl,sp /
+// call" for locals and "ld hl,addr / call" for statics, wait states of the board add to it
+#define TICKS_OVERHEAD    295
+
+// 40-bit value of tick counter, lowest byte first
+typedef struct {
+  uint8_t b[5];
+} ticks_t;
+
+// reads tick counter at MEM_TICKS (0xF880..0xF884), read is repeated if carry happened in the middle of it
+void ticks_snapshot(ticks_t * dst) __z88dk_fastcall;
+
+// result = end - start - TICKS_OVERHEAD, 0 if end is too close to start
+void ticks_elapsed(ticks_t * result, ticks_t * start, ticks_t * end);
+
+// returns (src >> shift), 0xFFFFFFFF if it doesn't fit 32 bits
+uint32_t ticks_toU32(ticks_t * src, uint8_t shift);
+
+// prints "prefix: XXXXXXXXXX ticks"
+void ticks_print(char * prefix, ticks_t * src);
+
+#endif
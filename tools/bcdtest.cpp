@@ -0,0 +1,243 @@
+// host tester of programs/pi_chudnovsky_bcd/bn.c: random add, sub, mul, divmod, powers of 10 and
+// comparison are checked against BigRef, --bench prints ns/op by operand size
+
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+#include "bigref.h"
+#include "bnslots.h"
+#include "options.h"
+
+extern "C" {
+#include "bn.h"
+}
+
+using namespace sbc;
+
+typedef BigRef<10> Ref;
+
+// SLOT_SIZE of pi_chudnovsky_bcd/pi.c
+const size_t kSlotSize = 0x2800;
+const size_t kSlots = 5;
+// digits of slot after msd field
+const size_t kMaxDigits = kSlotSize - sizeof(bn);
+// slots are filled with it before each case, it isn't a decimal digit
+const uint8_t kJunk = 0x5A;
+
+static void usage() {
+  std::fprintf(stderr,
+    "usage: bcdtest [options] [add|sub|mul|div|pow10|eq...]\n"
+    "  --iterations N    random cases of each operation (default 2000)\n"
+    "  --max-size N      largest operand in digits (default 200, up to 4096)\n"
+    "  --seed N          random seed (default 1)\n"
+    "  --bench           prints ns/op by operand size instead of testing\n"
+    "  --bench-ms N      time spent on each measurement (default 50)\n");
+  std::exit(2);
+}
+
+static bn * load(uint8_t * slot, const std::vector<uint8_t> & digits) {
+  bn * dst = (bn *)slot;
+  dst->msd = digits.size() - 1;
+  std::copy(digits.begin(), digits.end(), dst->digits);
+  return dst;
+}
+
+static Ref value(const bn * src) {
+  return Ref(src->digits, src->msd + 1u);
+}
+
+class Tester {
+public:
+  Tester(uint64_t seed, size_t maxSize) : slots(kSlots, kSlotSize), rnd(seed), maxSize(maxSize) { }
+
+  unsigned failures = 0;
+
+  void run(const std::string & op) {
+    slots.clear(kJunk);
+    if (op == "add") {
+      // pi.c adds in place, bn_add(a, a, aK)
+      std::vector<uint8_t> x = operand(), y = operand();
+      bn * term1 = load(slots[0], x), * term2 = load(slots[1], y);
+      bn * result = rnd.below(2) ? term1 : (bn *)slots[2];
+      bn_add(result, term1, term2);
+      check(op, value(result), ref(x) + ref(y), x, y);
+    } else if (op == "sub") {
+      // smaller minuend is reported by borrow, result is undefined then
+      std::vector<uint8_t> x = operand(), y = operand();
+      bn * minuend = load(slots[0], x), * subtrahend = load(slots[1], y);
+      bn * result = rnd.below(2) ? minuend : (bn *)slots[2];
+      uint8_t borrow = bn_sub(result, minuend, subtrahend);
+      bool smaller = ref(x) < ref(y);
+      check(op, Ref::fromInt(borrow), Ref::fromInt(smaller), x, y);
+      if (!smaller) {
+        check(op, value(result), ref(x) - ref(y), x, y);
+      }
+    } else if (op == "mul") {
+      // factor2 is shifted in place and needs room for digits of both factors
+      std::vector<uint8_t> x = operand(), y = operand();
+      bn * factor1 = load(slots[1], x), * factor2 = load(slots[2], y);
+      bn * result = (bn *)slots[0];
+      bn_mul(result, factor1, factor2);
+      check(op, value(result), ref(x) * ref(y), x, y);
+    } else if (op == "div") {
+      // quotient takes place of dividend in pi.c, bn_divmod(aK, small0, t0, small1, small2)
+      std::vector<uint8_t> y = operand();
+      std::vector<uint8_t> x = rnd.digits(1 + rnd.below(maxSize), 10);
+      bn * dividend = load(slots[1], x), * divisor = load(slots[2], y);
+      bn * quotient = rnd.below(2) ? dividend : (bn *)slots[0];
+      bn * reminder = (bn *)slots[3], * tmp = (bn *)slots[4];
+      bn_divmod(quotient, reminder, dividend, divisor, tmp);
+      Ref q, r;
+      Ref::divmod(ref(x), ref(y), q, r);
+      check(op, value(quotient), q, x, y);
+      check("mod", value(reminder), r, x, y);
+    } else if (op == "pow10") {
+      // bn_powerOf10(), then x is shifted up and back by the same power
+      std::vector<uint8_t> x = operand();
+      unsigned power = 1 + rnd.below(maxSize);
+      bn * result = (bn *)slots[0];
+      bn_powerOf10(result, power);
+      Ref expected;
+      expected.d.assign(power, 0);
+      expected.d.push_back(1);
+      check(op, value(result), expected, x, {});
+      bn * term = load(slots[1], x);
+      bn_mulByPowerOf10(term, power);
+      check(op, value(term), ref(x) * expected, x, {});
+      bn_divByPowerOf10(term, power);
+      check(op, value(term), ref(x), x, {});
+    } else if (op == "eq") {
+      // equal numbers, or numbers with one different digit
+      std::vector<uint8_t> x = operand(), y = x;
+      bool same = rnd.below(2);
+      if (!same) {
+        uint8_t & digit = y[rnd.below(y.size())];
+        digit = (digit + 1 + rnd.below(9)) % 10;
+        if (y.back() == 0) {
+          y.back() = x.back() == 1 ? 2 : 1;
+        }
+      }
+      uint8_t equal = bn_isEqual(load(slots[0], x), load(slots[1], y));
+      check(op, Ref::fromInt(equal), Ref::fromInt(x == y), x, y);
+    } else {
+      throw std::runtime_error("unknown operation " + op);
+    }
+  }
+
+private:
+  Slots slots;
+  Operands rnd;
+  size_t maxSize;
+
+  static Ref ref(const std::vector<uint8_t> & digits) {
+    return Ref(digits.data(), digits.size());
+  }
+
+  std::vector<uint8_t> operand() {
+    return rnd.digits(1 + rnd.below(maxSize), 10);
+  }
+
+  void check(const std::string & op, const Ref & got, const Ref & expected, const std::vector<uint8_t> & x,
+      const std::vector<uint8_t> & y) {
+    int damaged = slots.damaged();
+    if (got == expected && damaged < 0) {
+      return;
+    }
+    // only first few failures are printed in full
+    if (++failures > 5) {
+      return;
+    }
+    std::printf("%s failed%s\n  x = %s\n", op.c_str(), got == expected ? ", write out of slot" : "",
+      ref(x).str().c_str());
+    if (!y.empty()) {
+      std::printf("  y = %s\n", ref(y).str().c_str());
+    }
+    std::printf("  got      %s\n  expected %s\n", got.str().c_str(), expected.str().c_str());
+    if (damaged >= 0) {
+      std::printf("  guard bytes of slot %d are changed\n", damaged);
+    }
+  }
+};
+
+static void bench(double ms) {
+  Slots slots(kSlots, kSlotSize);
+  Operands rnd(1);
+  std::printf("%6s %12s %12s %12s %12s\n", "digits", "add ns", "sub ns", "mul ns", "div ns");
+  for (size_t size = 4; size <= 2048; size *= 2) {
+    std::vector<uint8_t> x = rnd.digits(size, 10), y = rnd.digits(size, 10), x2 = rnd.digits(size * 2, 10);
+    if (Ref(x.data(), x.size()) < Ref(y.data(), y.size())) {
+      std::swap(x, y);
+    }
+    bn * a, * b, * c = (bn *)slots[2], * t3 = (bn *)slots[3], * t4 = (bn *)slots[4];
+
+    auto setAB = [&]() {
+      a = load(slots[0], x);
+      b = load(slots[1], y);
+    };
+    double add = nsPerOp(setAB, [&]() { bn_add(c, a, b); }, ms);
+    double sub = nsPerOp(setAB, [&]() { bn_sub(c, a, b); }, ms);
+    double mul = nsPerOp(setAB, [&]() { bn_mul(c, a, b); }, ms);
+    // 2n by n digits
+    auto setDiv = [&]() {
+      a = load(slots[0], x2);
+      b = load(slots[1], y);
+    };
+    double div = nsPerOp(setDiv, [&]() { bn_divmod(c, t3, a, b, t4); }, ms);
+    std::printf("%6zu %12.1f %12.1f %12.1f %12.1f\n", size, add, sub, mul, div);
+  }
+}
+
+int main(int argc, char ** argv) {
+  Options options(argc, argv);
+  uint64_t iterations = 2000, seed = 1, maxSize = 200, benchMs = 50;
+  bool doBench = false;
+  std::set<std::string> ops;
+  try {
+    while (options.next()) {
+      if (options.is("--iterations")) {
+        iterations = options.number();
+      } else if (options.is("--max-size")) {
+        maxSize = options.number();
+      } else if (options.is("--seed")) {
+        seed = options.number();
+      } else if (options.is("--bench")) {
+        doBench = true;
+      } else if (options.is("--bench-ms")) {
+        benchMs = options.number();
+      } else if (options.isPositional()) {
+        ops.insert(options.current());
+      } else {
+        usage();
+      }
+    }
+    // product of two operands should fit into a slot
+    if (maxSize < 1 || maxSize > 4096 || 2 * maxSize + 1 > kMaxDigits) {
+      usage();
+    }
+    if (doBench) {
+      bench(benchMs);
+      return 0;
+    }
+    if (ops.empty()) {
+      ops = { "add", "sub", "mul", "div", "pow10", "eq" };
+    }
+
+    Tester tester(seed, maxSize);
+    bool ok = true;
+    for (const std::string & op : ops) {
+      tester.failures = 0;
+      for (uint64_t i = 0; i < iterations; i++) {
+        tester.run(op);
+      }
+      std::printf("%-5s %llu cases, %u failed\n", op.c_str(), (unsigned long long)iterations, tester.failures);
+      ok &= tester.failures == 0;
+    }
+    return ok ? 0 : 1;
+  } catch (const std::exception & e) {
+    std::fprintf(stderr, "bcdtest: %s\n", e.what());
+    return 2;
+  }
+}
@@ -0,0 +1,178 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+
+#include "blockengine.h"
+#include "layout.h"
+#include "mapfile.h"
+
+namespace sbc {
+
+static std::string trim(const std::string & s) {
+  size_t begin = s.find_first_not_of(" \t\r\n");
+  if (begin == std::string::npos) {
+    return "";
+  }
+  size_t end = s.find_last_not_of(" \t\r\n");
+  return s.substr(begin, end - begin + 1);
+}
+
+std::vector<Metric> parseTicks(const std::string & output) {
+  static const std::regex hexTicks("^(.+): ([0-9A-F]{10}) ticks$");
+  static const std::regex decTicks("^(.+): ([0-9]+) ticks\\b.*");
+  static const std::regex ticksField("^(.+?) ticks *: *([0-9]+)$");
+
+  std::vector<Metric> metrics;
+  std::map<std::string, unsigned> seen;
+  std::istringstream in(output);
+  std::string line;
+  while (std::getline(in, line)) {
+    line = trim(line);
+    std::smatch m;
+    uint64_t value;
+    if (std::regex_match(line, m, hexTicks)) {
+      value = std::stoull(m[2], nullptr, 16);
+    } else if (std::regex_match(line, m, decTicks) || std::regex_match(line, m, ticksField)) {
+      value = std::stoull(m[2]);
+    } else {
+      continue;
+    }
+    // names go to CSV file
+    std::string name = trim(m[1]);
+    // counter values of snapshots move with everything before them, only differences are compared
+    if (name == "Start" || name == "End") {
+      continue;
+    }
+    std::replace(name.begin(), name.end(), ',', ' ');
+    unsigned n = ++seen[name];
+    if (n > 1) {
+      name += "#" + std::to_string(n);
+    }
+    metrics.push_back({ name, value });
+  }
+  return metrics;
+}
+
+Config imageConfig(const std::string & image) {
+  Config config;
+  if (std::ifstream(image + ".map")) {
+    MapFile map;
+    map.load(image + ".map");
+    std::vector<std::string> problems = checkLayout(map);
+    if (!problems.empty()) {
+      throw std::runtime_error(image + ": " + problems.front());
+    }
+    if (const Symbol * cleanup = map.find("cleanup")) {
+      config.stopAddr = cleanup->value;
+    }
+    config.txIrq = map.find("fifo_put") != nullptr;
+  }
+  return config;
+}
+
+RunResult runImage(const std::string & image, uint64_t maxCycles) {
+  Machine machine(imageConfig(image));
+  machine.load(image);
+  BlockEngine engine(machine);
+
+  RunResult result;
+  result.stop = engine.run(maxCycles);
+  result.cycles = machine.cpu.cycles;
+  result.output = machine.output;
+  result.metrics.push_back({ "cycles", machine.cpu.cycles });
+  for (size_t i = 1; i < machine.markers.size(); i++) {
+    result.metrics.push_back({ "marker " + std::to_string(i) + "-" + std::to_string(i + 1),
+      machine.markers[i] - machine.markers[i - 1] });
+  }
+  for (const Metric & metric : parseTicks(machine.output)) {
+    result.metrics.push_back(metric);
+  }
+  return result;
+}
+
+std::vector<std::string> findImages(const std::string & programs) {
+  namespace fs = std::filesystem;
+  std::vector<std::string> images;
+  for (const fs::directory_entry & dir : fs::directory_iterator(programs)) {
+    if (!dir.is_directory()) {
+      continue;
+    }
+    for (const fs::directory_entry & file : fs::directory_iterator(dir.path())) {
+      if (file.is_regular_file() && !file.path().has_extension()) {
+        images.push_back(file.path().string());
+      }
+    }
+  }
+  std::sort(images.begin(), images.end());
+  return images;
+}
+
+std::vector<std::string> buildCommands(const std::string & buildBat) {
+  std::vector<std::string> commands;
+  std::ifstream in(buildBat);
+  std::string line;
+  while (std::getline(in, line)) {
+    line = trim(line);
+    if (line.compare(0, 4, "zcc ") == 0) {
+      commands.push_back(line);
+    }
+  }
+  return commands;
+}
+
+std::string outputName(const std::string & command) {
+  size_t pos = command.find(" -o ");
+  if (pos == std::string::npos) {
+    return "";
+  }
+  pos += 4;
+  return command.substr(pos, command.find(' ', pos) - pos);
+}
+
+std::vector<Record> loadHistory(const std::string & path) {
+  std::vector<Record> records;
+  std::ifstream in(path);
+  std::string line;
+  unsigned lineNo = 0;
+  while (std::getline(in, line)) {
+    lineNo++;
+    line = trim(line);
+    if (lineNo == 1 || line.empty()) {
+      continue;
+    }
+    std::vector<std::string> fields;
+    std::istringstream fieldsIn(line);
+    std::string field;
+    while (std::getline(fieldsIn, field, ',')) {
+      fields.push_back(field);
+    }
+    if (fields.size() != 5) {
+      throw std::runtime_error(path + ":" + std::to_string(lineNo) + ": expected 5 fields");
+    }
+    try {
+      records.push_back({ fields[0], std::stoull(fields[1]), fields[2], fields[3], std::stoull(fields[4]) });
+    } catch (const std::logic_error &) {
+      throw std::runtime_error(path + ":" + std::to_string(lineNo) + ": bad number");
+    }
+  }
+  return records;
+}
+
+void saveHistory(const std::string & path, const std::vector<Record> & records) {
+  std::ofstream out(path);
+  if (!out) {
+    throw std::runtime_error("can't write " + path);
+  }
+  out << "commit,time,image,metric,value\n";
+  for (const Record & r : records) {
+    out << r.commit << ',' << r.time << ',' << r.image << ',' << r.metric << ',' << r.value << '\n';
+  }
+}
+
+}
@@ -0,0 +1,68 @@
+#ifndef __SBC_BENCH_H__
+#define __SBC_BENCH_H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "machine.h"
+
+namespace sbc {
+
+// named number taken from one run: "cycles" of whole run, "marker N-M" cycles between 0x05 markers
+// and tick values printed by program
+struct Metric {
+  std::string name;
+  uint64_t value;
+};
+
+struct RunResult {
+  Stop stop = Stop::Halt;
+  uint64_t cycles = 0;
+  std::string output;
+  std::vector<Metric> metrics;
+};
+
+// tick values of program output, recognised lines are
+//   "Elapsed: 000346A1E4 ticks"   printed by ticks_print(), hex
+//   "Total ticks      : 1128404099"   CoreMark, name is "Total"
+//   "  Elapsed: 54895268 ticks, "   Dhrystone, decimal
+// "Start" and "End" lines of ticks_print() are counter snapshots, not differences, so they are skipped;
+// Dhrystone "Startup" stays, it counts from reset and counter starts at 0 in emulator;
+// repeated names get "#2", "#3"... suffix
+std::vector<Metric> parseTicks(const std::string & output);
+
+// config for image: run stops at "cleanup" from image.map, transmitter interrupt is enabled
+// when .map has "fifo_put" (CONS_FIFO build of hal.asm); throws std::runtime_error when image.map
+// fails checkLayout()
+Config imageConfig(const std::string & image);
+
+// runs image with block engine and imageConfig()
+RunResult runImage(const std::string & image, uint64_t maxCycles);
+
+// program images of suite: files without extension in subfolders of programs folder, sorted by path
+std::vector<std::string> findImages(const std::string & programs);
+
+// "zcc ..." lines of build.bat
+std::vector<std::string> buildCommands(const std::string & buildBat);
+
+// image name given with "-o" in zcc command, empty if there is none
+std::string outputName(const std::string & command);
+
+// one metric of one image measured at one commit, line of history file
+struct Record {
+  std::string commit;
+  uint64_t time;
+  std::string image;
+  std::string metric;
+  uint64_t value;
+};
+
+// history file is CSV "commit,time,image,metric,value" with header line, empty if file doesn't exist,
+// throws std::runtime_error on malformed line
+std::vector<Record> loadHistory(const std::string & path);
+void saveHistory(const std::string & path, const std::vector<Record> & records);
+
+}
+
+#endif
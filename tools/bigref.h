@@ -0,0 +1,193 @@
+#ifndef __SBC_BIGREF_H__
+#define __SBC_BIGREF_H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sbc {
+
+// unsigned big integer in base 256 (pi_chudnovsky/bn.c) or 10 (pi_chudnovsky_bcd/bn.c), little-endian
+// digits without leading zeros, zero has no digits; slow but plain reference for host tests of bn libraries
+template <unsigned Base>
+struct BigRef {
+  std::vector<uint8_t> d;
+
+  BigRef() = default;
+
+  BigRef(const uint8_t * digits, size_t size) : d(digits, digits + size) {
+    trim();
+  }
+
+  static BigRef fromInt(uint64_t v) {
+    BigRef r;
+    for (; v != 0; v /= Base) {
+      r.d.push_back(v % Base);
+    }
+    return r;
+  }
+
+  bool isZero() const {
+    return d.empty();
+  }
+
+  // single resize, with pop_back per digit inlined into callers GCC loses track of vector storage
+  // and warns that destructor frees pointer with offset (-Wfree-nonheap-object)
+  void trim() {
+    size_t size = d.size();
+    while (size != 0 && d[size - 1] == 0) {
+      size--;
+    }
+    d.resize(size);
+  }
+
+  // -1, 0 or 1
+  friend int compare(const BigRef & a, const BigRef & b) {
+    if (a.d.size() != b.d.size()) {
+      return a.d.size() < b.d.size() ? -1 : 1;
+    }
+    for (size_t i = a.d.size(); i-- > 0; ) {
+      if (a.d[i] != b.d[i]) {
+        return a.d[i] < b.d[i] ? -1 : 1;
+      }
+    }
+    return 0;
+  }
+
+  friend bool operator==(const BigRef & a, const BigRef & b) { return compare(a, b) == 0; }
+  friend bool operator!=(const BigRef & a, const BigRef & b) { return compare(a, b) != 0; }
+  friend bool operator<(const BigRef & a, const BigRef & b) { return compare(a, b) < 0; }
+  friend bool operator<=(const BigRef & a, const BigRef & b) { return compare(a, b) <= 0; }
+
+  friend BigRef operator+(const BigRef & a, const BigRef & b) {
+    BigRef r;
+    unsigned carry = 0;
+    for (size_t i = 0; i < a.d.size() || i < b.d.size() || carry; i++) {
+      unsigned v = carry + (i < a.d.size() ? a.d[i] : 0) + (i < b.d.size() ? b.d[i] : 0);
+      r.d.push_back(v % Base);
+      carry = v / Base;
+    }
+    return r;
+  }
+
+  // a should not be less than b
+  friend BigRef operator-(const BigRef & a, const BigRef & b) {
+    BigRef r;
+    int borrow = 0;
+    for (size_t i = 0; i < a.d.size(); i++) {
+      int v = (int)a.d[i] - (i < b.d.size() ? b.d[i] : 0) - borrow;
+      borrow = v < 0;
+      r.d.push_back(v < 0 ? v + Base : v);
+    }
+    r.trim();
+    return r;
+  }
+
+  friend BigRef operator*(const BigRef & a, const BigRef & b) {
+    if (a.isZero() || b.isZero()) {
+      return BigRef();
+    }
+    std::vector<uint32_t> acc(a.d.size() + b.d.size() + 1);
+    for (size_t i = 0; i < a.d.size(); i++) {
+      uint32_t carry = 0;
+      for (size_t j = 0; j < b.d.size(); j++) {
+        uint32_t v = acc[i + j] + (uint32_t)a.d[i] * b.d[j] + carry;
+        acc[i + j] = v % Base;
+        carry = v / Base;
+      }
+      for (size_t k = i + b.d.size(); carry != 0; k++) {
+        uint32_t v = acc[k] + carry;
+        acc[k] = v % Base;
+        carry = v / Base;
+      }
+    }
+    BigRef r;
+    r.d.assign(acc.begin(), acc.end());
+    r.trim();
+    return r;
+  }
+
+  BigRef mulSmall(unsigned m) const {
+    return *this * fromInt(m);
+  }
+
+  BigRef divSmall(unsigned m) const {
+    BigRef r;
+    r.d.resize(d.size());
+    uint32_t rem = 0;
+    for (size_t i = d.size(); i-- > 0; ) {
+      uint32_t v = rem * Base + d[i];
+      r.d[i] = v / m;
+      rem = v % m;
+    }
+    r.trim();
+    return r;
+  }
+
+  // long division, each quotient digit is found by binary search, b should not be zero
+  static void divmod(const BigRef & a, const BigRef & b, BigRef & quotient, BigRef & remainder) {
+    quotient.d.assign(a.d.size(), 0);
+    remainder = BigRef();
+    for (size_t i = a.d.size(); i-- > 0; ) {
+      remainder.d.insert(remainder.d.begin(), a.d[i]);
+      remainder.trim();
+      unsigned lo = 0, hi = Base - 1;
+      while (lo < hi) {
+        unsigned mid = (lo + hi + 1) / 2;
+        if (b.mulSmall(mid) <= remainder) {
+          lo = mid;
+        } else {
+          hi = mid - 1;
+        }
+      }
+      quotient.d[i] = lo;
+      remainder = remainder - b.mulSmall(lo);
+    }
+    quotient.trim();
+  }
+
+  friend BigRef operator/(const BigRef & a, const BigRef & b) {
+    BigRef q, r;
+    divmod(a, b, q, r);
+    return q;
+  }
+
+  // floor of square root, Newton iterations from a value above the root
+  BigRef isqrt() const {
+    if (isZero()) {
+      return BigRef();
+    }
+    BigRef x;
+    x.d.assign((d.size() + 1) / 2, 0);
+    x.d.push_back(1);
+    while (true) {
+      BigRef y = (x + *this / x).divSmall(2);
+      if (x <= y) {
+        return x;
+      }
+      x = y;
+    }
+  }
+
+  // most significant digit first, hex digit pairs for base 256
+  std::string str() const {
+    if (isZero()) {
+      return "0";
+    }
+    static const char kHex[] = "0123456789ABCDEF";
+    std::string s;
+    for (size_t i = d.size(); i-- > 0; ) {
+      if (Base == 256) {
+        s += kHex[d[i] >> 4];
+        s += kHex[d[i] & 0xF];
+      } else {
+        s += (char)('0' + d[i]);
+      }
+    }
+    return s;
+  }
+};
+
+}
+
+#endif
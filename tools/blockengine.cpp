@@ -0,0 +1,609 @@
+#include "blockengine.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+
+namespace sbc {
+
+namespace {
+
+const uint8_t FLAG_S = 0x80;
+const uint8_t FLAG_Z = 0x40;
+const uint8_t FLAG_H = 0x10;
+const uint8_t FLAG_P = 0x04;
+const uint8_t FLAG_C = 0x01;
+// bit 1 of PSW is always set
+const uint8_t FLAG_1 = 0x02;
+
+// blocks end after this many instructions, so a block never spans more than 2 pages
+const unsigned kMaxBlockOps = 48;
+
+struct Op;
+typedef void (*Handler)(BlockEngine::Impl & e, const Op & op);
+
+struct Op {
+  Handler fn;
+  // immediate operand, 8-bit ones are in low byte
+  uint16_t imm;
+  // address of the next instruction
+  uint16_t next;
+  // datasheet cycles and fetch wait states
+  uint8_t cycles;
+};
+
+struct Block {
+  uint16_t start;
+  // number of bytes decoded, instructions may wrap around 0xFFFF
+  uint16_t size;
+  // cycles of all instructions without taken CALL/RET extra, with upper bound of data wait states
+  uint32_t cycles;
+  bool dead = false;
+  std::vector<Op> ops;
+};
+
+struct SzpTable {
+  uint8_t v[256];
+
+  SzpTable() {
+    for (unsigned i = 0; i < 256; i++) {
+      v[i] = (i & FLAG_S) | (i == 0 ? FLAG_Z : 0) | (kParity[i] ? FLAG_P : 0) | FLAG_1;
+    }
+  }
+};
+
+const SzpTable kSzp;
+
+bool isTerminator(uint8_t opcode) {
+  switch (opcode) {
+    case 0x76: case 0xD3: case 0xE9: case 0xF3: case 0xFB:
+    case 0xC3: case 0xCB: case 0xC9: case 0xD9: case 0xCD: case 0xDD: case 0xED: case 0xFD:
+      return true;
+  }
+  // Rcc, Jcc, Ccc, RST
+  unsigned low = opcode & 0xC7;
+  return low == 0xC0 || low == 0xC2 || low == 0xC4 || low == 0xC7;
+}
+
+}
+
+struct BlockEngine::Impl {
+  Machine & m;
+  uint8_t * mem;
+
+  // B, C, D, E, H, L, unused, A, so that 3-bit register codes index it
+  uint8_t r[8] = { };
+  uint8_t f = FLAG_1;
+  uint16_t sp = 0, pc = 0;
+  uint64_t cycles = 0;
+  bool inte = false, eiDelay = false, halted = false;
+  // set when write hits decoded code or marker pauses run, running block stops after current instruction
+  bool abort = false;
+  // wait states of config, taken when run starts, waits is false when ROM and RAM ones are 0
+  bool waits = false;
+  uint16_t romEnd = kRomEnd;
+  unsigned romWait = 0, ramWait = 0;
+
+  std::vector<Block *> cache;
+  // number of live blocks decoded from each byte
+  std::vector<uint16_t> codeRefs;
+  std::array<std::vector<Block *>, 256> pageBlocks;
+  // invalidated blocks, freed between blocks, as one of them may be running
+  std::vector<Block *> graveyard;
+
+  uint64_t decoded = 0, invalidated = 0;
+
+  explicit Impl(Machine & machine) : m(machine), mem(machine.mem), cache(0x10000, nullptr), codeRefs(0x10000, 0) { }
+
+  ~Impl() {
+    freeGraveyard();
+    for (Block * b : cache) {
+      delete b;
+    }
+  }
+
+  uint16_t hl() const { return (r[4] << 8) | r[5]; }
+
+  uint16_t pair(unsigned n) const {
+    return n == 3 ? sp : (r[n * 2] << 8) | r[n * 2 + 1];
+  }
+
+  void setPair(unsigned n, uint16_t v) {
+    if (n == 3) {
+      sp = v;
+    } else {
+      r[n * 2] = v >> 8;
+      r[n * 2 + 1] = v;
+    }
+  }
+
+  uint8_t read(uint16_t addr) {
+    if ((uint16_t)(addr - kTicksAddr) < kTicksSize) {
+      cycles += m.config.ticksWait;
+      m.cpu.cycles = cycles;
+      return m.read(addr);
+    }
+    if (waits) {
+      cycles += addr < romEnd ? romWait : ramWait;
+    }
+    return mem[addr];
+  }
+
+  void write(uint16_t addr, uint8_t v) {
+    if ((uint16_t)(addr - kTicksAddr) < kTicksSize) {
+      cycles += m.config.ticksWait;
+      return;
+    }
+    if (waits) {
+      cycles += addr < romEnd ? romWait : ramWait;
+    }
+    mem[addr] = v;
+    if (codeRefs[addr] != 0) {
+      invalidate(addr);
+    }
+  }
+
+  uint16_t read16(uint16_t addr) {
+    uint8_t lo = read(addr);
+    return lo | (read(addr + 1) << 8);
+  }
+
+  void write16(uint16_t addr, uint16_t v) {
+    write(addr, v);
+    write(addr + 1, v >> 8);
+  }
+
+  void push16(uint16_t v) {
+    sp -= 2;
+    write16(sp, v);
+  }
+
+  uint16_t pop16() {
+    uint16_t v = read16(sp);
+    sp += 2;
+    return v;
+  }
+
+  bool cond(unsigned n) const {
+    static const uint8_t masks[4] = { FLAG_Z, FLAG_C, FLAG_P, FLAG_S };
+    bool set = f & masks[n >> 1];
+    return (n & 1) ? set : !set;
+  }
+
+  void add(uint8_t v, unsigned carry) {
+    unsigned res = r[7] + v + carry;
+    f = kSzp.v[res & 0xFF] | ((r[7] ^ v ^ res) & FLAG_H) | (res >> 8);
+    r[7] = res;
+  }
+
+  // same flags as reference core: AC is carry of addition of complement, CY is borrow
+  uint8_t sub(uint8_t v, unsigned borrow) {
+    uint8_t n = ~v;
+    unsigned res = r[7] + n + (borrow ^ 1);
+    f = kSzp.v[res & 0xFF] | ((r[7] ^ n ^ res) & FLAG_H) | ((res >> 8) ^ 1);
+    return res;
+  }
+
+  template <unsigned N>
+  void alu(uint8_t v) {
+    if constexpr (N == 0) {
+      add(v, 0);
+    } else if constexpr (N == 1) {
+      add(v, f & FLAG_C);
+    } else if constexpr (N == 2) {
+      r[7] = sub(v, 0);
+    } else if constexpr (N == 3) {
+      r[7] = sub(v, f & FLAG_C);
+    } else if constexpr (N == 4) {
+      f = kSzp.v[r[7] & v] | (((r[7] | v) & 0x08) << 1);
+      r[7] &= v;
+    } else if constexpr (N == 5) {
+      r[7] ^= v;
+      f = kSzp.v[r[7]];
+    } else if constexpr (N == 6) {
+      r[7] |= v;
+      f = kSzp.v[r[7]];
+    } else {
+      sub(v, 0);
+    }
+  }
+
+  uint8_t inr(uint8_t v) {
+    v++;
+    f = (f & FLAG_C) | kSzp.v[v] | ((v & 0x0F) == 0 ? FLAG_H : 0);
+    return v;
+  }
+
+  uint8_t dcr(uint8_t v) {
+    v--;
+    f = (f & FLAG_C) | kSzp.v[v] | ((v & 0x0F) != 0x0F ? FLAG_H : 0);
+    return v;
+  }
+
+  void daa() {
+    unsigned carry = f & FLAG_C;
+    uint8_t correction = 0;
+    uint8_t lsb = r[7] & 0x0F;
+    uint8_t msb = r[7] >> 4;
+    if ((f & FLAG_H) || lsb > 9) {
+      correction += 0x06;
+    }
+    if ((f & FLAG_C) || msb > 9 || (msb >= 9 && lsb > 9)) {
+      correction += 0x60;
+      carry = 1;
+    }
+    add(correction, 0);
+    f = (f & ~FLAG_C) | carry;
+  }
+
+  void load() {
+    const Cpu & cpu = m.cpu;
+    r[0] = cpu.b; r[1] = cpu.c; r[2] = cpu.d; r[3] = cpu.e; r[4] = cpu.h; r[5] = cpu.l; r[7] = cpu.a;
+    f = cpu.psw();
+    sp = cpu.sp;
+    pc = cpu.pc;
+    cycles = cpu.cycles;
+    inte = cpu.inte;
+    eiDelay = cpu.eiDelay;
+    halted = cpu.halted;
+    romEnd = m.config.romEnd;
+    romWait = m.config.romWait;
+    ramWait = m.config.ramWait;
+    waits = romWait != 0 || ramWait != 0;
+  }
+
+  void store() {
+    Cpu & cpu = m.cpu;
+    cpu.b = r[0]; cpu.c = r[1]; cpu.d = r[2]; cpu.e = r[3]; cpu.h = r[4]; cpu.l = r[5]; cpu.a = r[7];
+    cpu.setPsw(f);
+    cpu.sp = sp;
+    cpu.pc = pc;
+    cpu.cycles = cycles;
+    cpu.inte = inte;
+    cpu.eiDelay = eiDelay;
+    cpu.halted = halted;
+  }
+
+  Block * decode(uint16_t start);
+  void invalidate(uint16_t addr);
+  void drop(Block * b);
+
+  void freeGraveyard() {
+    for (Block * b : graveyard) {
+      delete b;
+    }
+    graveyard.clear();
+  }
+
+  Stop run(uint64_t maxCycles);
+};
+
+namespace {
+
+// one handler per opcode, registers, ALU operation and condition are template constants
+template <unsigned OP>
+void exec(BlockEngine::Impl & e, const Op & op) {
+  constexpr unsigned D = (OP >> 3) & 7;
+  constexpr unsigned S = OP & 7;
+  constexpr unsigned P = (OP >> 4) & 3;
+
+  if constexpr (OP == 0x76) {
+    e.halted = true;
+    e.pc = op.next;
+  } else if constexpr (OP >= 0x40 && OP < 0x80) {
+    if constexpr (S == 6) {
+      e.r[D] = e.read(e.hl());
+    } else if constexpr (D == 6) {
+      e.write(e.hl(), e.r[S]);
+    } else {
+      e.r[D] = e.r[S];
+    }
+  } else if constexpr (OP >= 0x80 && OP < 0xC0) {
+    if constexpr (S == 6) {
+      e.template alu<D>(e.read(e.hl()));
+    } else {
+      e.template alu<D>(e.r[S]);
+    }
+  } else if constexpr (OP < 0x40) {
+    if constexpr (S == 0) {
+      // NOP and undocumented copies
+    } else if constexpr (S == 1 && !(OP & 8)) {
+      e.setPair(P, op.imm);
+    } else if constexpr (S == 1) {
+      unsigned res = e.hl() + e.pair(P);
+      e.f = (e.f & ~FLAG_C) | (res >> 16);
+      e.setPair(2, res);
+    } else if constexpr (OP == 0x02 || OP == 0x12) {
+      e.write(e.pair(P), e.r[7]);
+    } else if constexpr (OP == 0x0A || OP == 0x1A) {
+      e.r[7] = e.read(e.pair(P));
+    } else if constexpr (OP == 0x22) {
+      e.write16(op.imm, e.hl());
+    } else if constexpr (OP == 0x2A) {
+      e.setPair(2, e.read16(op.imm));
+    } else if constexpr (OP == 0x32) {
+      e.write(op.imm, e.r[7]);
+    } else if constexpr (OP == 0x3A) {
+      e.r[7] = e.read(op.imm);
+    } else if constexpr (S == 3) {
+      e.setPair(P, e.pair(P) + ((OP & 8) ? -1 : 1));
+    } else if constexpr (S == 4 || S == 5) {
+      if constexpr (D == 6) {
+        uint8_t v = e.read(e.hl());
+        e.write(e.hl(), S == 4 ? e.inr(v) : e.dcr(v));
+      } else {
+        e.r[D] = S == 4 ? e.inr(e.r[D]) : e.dcr(e.r[D]);
+      }
+    } else if constexpr (S == 6) {
+      if constexpr (D == 6) {
+        e.write(e.hl(), op.imm);
+      } else {
+        e.r[D] = op.imm;
+      }
+    } else if constexpr (OP == 0x07) {
+      uint8_t a = e.r[7];
+      e.f = (e.f & ~FLAG_C) | (a >> 7);
+      e.r[7] = (a << 1) | (a >> 7);
+    } else if constexpr (OP == 0x0F) {
+      uint8_t a = e.r[7];
+      e.f = (e.f & ~FLAG_C) | (a & 1);
+      e.r[7] = (a >> 1) | (a << 7);
+    } else if constexpr (OP == 0x17) {
+      uint8_t a = e.r[7];
+      e.r[7] = (a << 1) | (e.f & FLAG_C);
+      e.f = (e.f & ~FLAG_C) | (a >> 7);
+    } else if constexpr (OP == 0x1F) {
+      uint8_t a = e.r[7];
+      e.r[7] = (a >> 1) | ((e.f & FLAG_C) << 7);
+      e.f = (e.f & ~FLAG_C) | (a & 1);
+    } else if constexpr (OP == 0x27) {
+      e.daa();
+    } else if constexpr (OP == 0x2F) {
+      e.r[7] = ~e.r[7];
+    } else if constexpr (OP == 0x37) {
+      e.f |= FLAG_C;
+    } else {
+      e.f ^= FLAG_C;
+    }
+  } else {
+    if constexpr (S == 0) {
+      if (e.cond(D)) {
+        e.pc = e.pop16();
+        e.cycles += kTakenExtra;
+      } else {
+        e.pc = op.next;
+      }
+    } else if constexpr (OP == 0xF1) {
+      uint16_t v = e.pop16();
+      e.r[7] = v >> 8;
+      e.f = (v & (FLAG_S | FLAG_Z | FLAG_H | FLAG_P | FLAG_C)) | FLAG_1;
+    } else if constexpr (S == 1 && !(OP & 8)) {
+      e.setPair(P, e.pop16());
+    } else if constexpr (OP == 0xC9 || OP == 0xD9) {
+      e.pc = e.pop16();
+    } else if constexpr (OP == 0xE9) {
+      e.pc = e.hl();
+    } else if constexpr (OP == 0xF9) {
+      e.sp = e.hl();
+    } else if constexpr (S == 2) {
+      e.pc = e.cond(D) ? op.imm : op.next;
+    } else if constexpr (OP == 0xC3 || OP == 0xCB) {
+      e.pc = op.imm;
+    } else if constexpr (OP == 0xD3) {
+      e.m.cpu.cycles = e.cycles;
+      e.m.out(op.imm, e.r[7]);
+      e.cycles = e.m.cpu.cycles;
+      e.pc = op.next;
+      // marker pause stops block after OUT
+      e.abort |= e.m.pausePending(op.next);
+    } else if constexpr (OP == 0xDB) {
+      e.r[7] = e.m.in(op.imm);
+    } else if constexpr (OP == 0xE3) {
+      uint16_t v = e.read16(e.sp);
+      e.write16(e.sp, e.hl());
+      e.setPair(2, v);
+    } else if constexpr (OP == 0xEB) {
+      std::swap(e.r[2], e.r[4]);
+      std::swap(e.r[3], e.r[5]);
+    } else if constexpr (OP == 0xF3) {
+      e.inte = false;
+      e.pc = op.next;
+    } else if constexpr (OP == 0xFB) {
+      e.inte = true;
+      e.eiDelay = true;
+      e.pc = op.next;
+    } else if constexpr (S == 4) {
+      if (e.cond(D)) {
+        e.push16(op.next);
+        e.pc = op.imm;
+        e.cycles += kTakenExtra;
+      } else {
+        e.pc = op.next;
+      }
+    } else if constexpr (OP == 0xF5) {
+      e.push16((e.r[7] << 8) | e.f);
+    } else if constexpr (S == 5 && !(OP & 8)) {
+      e.push16(e.pair(P));
+    } else if constexpr (S == 5) {
+      e.push16(op.next);
+      e.pc = op.imm;
+    } else if constexpr (S == 6) {
+      e.template alu<D>(op.imm);
+    } else {
+      e.push16(op.next);
+      e.pc = OP & 0x38;
+    }
+  }
+}
+
+template <size_t... I>
+constexpr std::array<Handler, 256> makeHandlers(std::index_sequence<I...>) {
+  return { { &exec<I>... } };
+}
+
+const std::array<Handler, 256> kHandlers = makeHandlers(std::make_index_sequence<256>());
+
+}
+
+Block * BlockEngine::Impl::decode(uint16_t start) {
+  Block * b = new Block();
+  b->start = start;
+  b->cycles = 0;
+  uint16_t addr = start;
+  unsigned size = 0;
+  // XTHL, CALL and RST make at most 4 data accesses
+  unsigned dataWait = 4 * std::max({ m.config.romWait, m.config.ramWait, m.config.ticksWait });
+  while (true) {
+    uint8_t opcode = mem[addr];
+    Op op;
+    op.fn = kHandlers[opcode];
+    op.imm = mem[(uint16_t)(addr + 1)] | (kLengths[opcode] == 3 ? mem[(uint16_t)(addr + 2)] << 8 : 0);
+    op.next = addr + kLengths[opcode];
+    op.cycles = kCycles[opcode];
+    for (unsigned i = 0; i < kLengths[opcode]; i++) {
+      op.cycles += m.waitStates(addr + i);
+    }
+    b->ops.push_back(op);
+    b->cycles += op.cycles + dataWait;
+    size += kLengths[opcode];
+    addr = op.next;
+    // stop and pause addresses should start a block, so run loop sees them
+    if (isTerminator(opcode) || b->ops.size() == kMaxBlockOps || addr == m.config.stopAddr || addr == m.config.pauseAddr) {
+      break;
+    }
+  }
+  b->size = size;
+
+  for (unsigned i = 0; i < size; i++) {
+    codeRefs[(uint16_t)(start + i)]++;
+  }
+  unsigned first = start >> 8;
+  unsigned last = (uint16_t)(start + size - 1) >> 8;
+  pageBlocks[first].push_back(b);
+  if (last != first) {
+    pageBlocks[last].push_back(b);
+  }
+  decoded++;
+  return b;
+}
+
+void BlockEngine::Impl::drop(Block * b) {
+  b->dead = true;
+  cache[b->start] = nullptr;
+  for (unsigned i = 0; i < b->size; i++) {
+    codeRefs[(uint16_t)(b->start + i)]--;
+  }
+  unsigned first = b->start >> 8;
+  unsigned last = (uint16_t)(b->start + b->size - 1) >> 8;
+  for (unsigned page : { first, last }) {
+    std::vector<Block *> & blocks = pageBlocks[page];
+    blocks.erase(std::remove(blocks.begin(), blocks.end(), b), blocks.end());
+  }
+  graveyard.push_back(b);
+  invalidated++;
+  abort = true;
+}
+
+void BlockEngine::Impl::invalidate(uint16_t addr) {
+  // blocks covering addr start in its page or in the previous one
+  for (unsigned page : { (unsigned)(addr >> 8), (unsigned)((uint16_t)(addr - 0x100) >> 8) }) {
+    std::vector<Block *> blocks = pageBlocks[page];
+    for (Block * b : blocks) {
+      if (!b->dead && (uint16_t)(addr - b->start) < b->size) {
+        drop(b);
+      }
+    }
+  }
+}
+
+Stop BlockEngine::Impl::run(uint64_t maxCycles) {
+  load();
+  Stop stop;
+  while (true) {
+    if (!graveyard.empty()) {
+      freeGraveyard();
+    }
+    if (pc == m.config.stopAddr) {
+      stop = Stop::Address;
+      break;
+    }
+    if (m.pausePending(pc)) {
+      stop = Stop::Pause;
+      break;
+    }
+    if (cycles >= maxCycles) {
+      stop = Stop::CycleLimit;
+      break;
+    }
+
+    if (m.config.txIrq) {
+      store();
+      if (m.irqPending()) {
+        inte = false;
+        halted = false;
+        push16(pc);
+        pc = 0x38;
+        cycles += kInterruptCycles;
+      }
+    }
+    if (halted) {
+      // same idle steps as Machine::run(), until interrupt comes
+      store();
+      if (!m.irqPossible()) {
+        stop = Stop::Halt;
+        break;
+      }
+      cycles += 4;
+      continue;
+    }
+
+    Block * b = cache[pc];
+    if (b == nullptr) {
+      b = cache[pc] = decode(pc);
+    }
+
+    // one instruction at a time when interrupt may come in the middle of block or block may cross cycle limit
+    size_t n = b->ops.size();
+    if (eiDelay || (m.config.txIrq && inte) || cycles + b->cycles + kTakenExtra > maxCycles) {
+      n = 1;
+    }
+    eiDelay = false;
+    pc = n == b->ops.size() ? (uint16_t)(b->start + b->size) : b->ops[n - 1].next;
+
+    const Op * op = b->ops.data();
+    const Op * end = op + n;
+    abort = false;
+    do {
+      op->fn(*this, *op);
+      cycles += op->cycles;
+      if (abort) {
+        abort = false;
+        if (op + 1 != end) {
+          pc = op->next;
+        }
+        break;
+      }
+    } while (++op != end);
+  }
+  store();
+  return stop;
+}
+
+BlockEngine::BlockEngine(Machine & machine) : impl(new Impl(machine)) { }
+
+BlockEngine::~BlockEngine() = default;
+
+Stop BlockEngine::run(uint64_t maxCycles) {
+  return impl->run(maxCycles);
+}
+
+uint64_t BlockEngine::blocksDecoded() const {
+  return impl->decoded;
+}
+
+uint64_t BlockEngine::blocksInvalidated() const {
+  return impl->invalidated;
+}
+
+}
@@ -0,0 +1,38 @@
+#ifndef __SBC_BLOCKENGINE_H__
+#define __SBC_BLOCKENGINE_H__
+
+#include <cstdint>
+#include <memory>
+
+#include "machine.h"
+
+namespace sbc {
+
+// fast replacement of Machine::run(): code is decoded once into basic blocks of pre-decoded instructions,
+// each with its own handler, blocks are cached by start address and dropped when a byte they were
+// decoded from is written
+//
+// cycle counts, tick counter reads, markers and stop conditions are the same as with Machine::run(),
+// near interrupts and cycle limit blocks are run one instruction at a time; there are no hooks,
+// tools that need them use Machine::run(); decoded blocks keep fetch wait states, so timing fields
+// of config shouldn't change while engine lives
+class BlockEngine {
+public:
+  explicit BlockEngine(Machine & machine);
+  ~BlockEngine();
+
+  // runs machine from its current state, machine.cpu is updated when run stops
+  Stop run(uint64_t maxCycles);
+
+  uint64_t blocksDecoded() const;
+  uint64_t blocksInvalidated() const;
+
+  struct Impl;
+
+private:
+  std::unique_ptr<Impl> impl;
+};
+
+}
+
+#endif
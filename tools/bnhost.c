@@ -0,0 +1,21 @@
+// host replacement of shared/hal.asm for bn.c of pi programs: console output goes to stdout
+//
+// bn.c doesn't use fixed addresses itself, pi.c places numbers at SLOT(i) and MEM_SMALL(i) of memmap.h,
+// host testers give each number a buffer of the same size instead
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "../shared/hal.h"
+
+int fputc_cons_native(char c) {
+  return putchar((unsigned char)c);
+}
+
+void cons_write(const uint8_t * buf, uint16_t len) {
+  fwrite(buf, 1, len, stdout);
+}
+
+void cons_flush(void) {
+  fflush(stdout);
+}
@@ -0,0 +1,120 @@
+#ifndef __SBC_BNSLOTS_H__
+#define __SBC_BNSLOTS_H__
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace sbc {
+
+// buffers of the same size as SLOT(i) of pi programs, each surrounded by guard bytes, so writes out
+// of slot are caught; slots themselves can be filled with junk, so reads of digits that were never
+// written show up
+class Slots {
+public:
+  static const size_t kGuard = 64;
+  static const uint8_t kAfter = 0xA5;
+
+  Slots(size_t count, size_t size) : count(count), size(size), mem(count * (size + 2 * kGuard)) {
+    clear();
+  }
+
+  uint8_t * operator[](size_t i) {
+    return &mem[i * (size + 2 * kGuard) + kGuard];
+  }
+
+  size_t slotSize() const {
+    return size;
+  }
+
+  void clear(uint8_t fill = 0) {
+    for (size_t i = 0; i < count; i++) {
+      uint8_t * slot = (*this)[i];
+      std::memset(slot - kGuard, 0, kGuard);
+      std::memset(slot, fill, size);
+      std::memset(slot + size, kAfter, kGuard);
+    }
+  }
+
+  // index of first slot with changed guard bytes, -1 if there is none
+  int damaged() {
+    for (size_t i = 0; i < count; i++) {
+      uint8_t * slot = (*this)[i];
+      for (size_t j = 0; j < kGuard; j++) {
+        if (*(slot - 1 - j) != 0 || slot[size + j] != kAfter) {
+          return (int)i;
+        }
+      }
+    }
+    return -1;
+  }
+
+private:
+  size_t count;
+  size_t size;
+  std::vector<uint8_t> mem;
+};
+
+// random operands: digits are random, or (one time of four) mostly lowest and highest digits,
+// so long carry and borrow chains come up; most significant digit is never zero
+class Operands {
+public:
+  explicit Operands(uint64_t seed) : rng(seed) { }
+
+  unsigned below(unsigned n) {
+    return std::uniform_int_distribution<unsigned>(0, n - 1)(rng);
+  }
+
+  std::vector<uint8_t> digits(size_t count, unsigned base) {
+    std::vector<uint8_t> d(count);
+    bool runs = below(4) == 0;
+    for (size_t i = 0; i < count; i++) {
+      if (runs && below(8) != 0) {
+        d[i] = below(2) ? base - 1 : 0;
+      } else {
+        d[i] = below(base);
+      }
+    }
+    if (count != 0 && d[count - 1] == 0) {
+      d[count - 1] = 1 + below(base - 1);
+    }
+    return d;
+  }
+
+private:
+  std::mt19937_64 rng;
+};
+
+// nanoseconds per op(), setup() runs before each op() and its time is subtracted
+template <class Setup, class Op>
+double nsPerOp(Setup setup, Op op, double minMs) {
+  using Clock = std::chrono::steady_clock;
+  auto elapsed = [](Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  };
+  uint64_t reps = 1;
+  while (true) {
+    Clock::time_point start = Clock::now();
+    for (uint64_t i = 0; i < reps; i++) {
+      setup();
+      op();
+    }
+    double total = elapsed(start);
+    if (total >= minMs * 1e6) {
+      start = Clock::now();
+      for (uint64_t i = 0; i < reps; i++) {
+        setup();
+      }
+      double setupOnly = elapsed(start);
+      return total > setupOnly ? (total - setupOnly) / reps : 0.0;
+    }
+    reps *= 2;
+  }
+}
+
+}
+
+#endif
@@ -0,0 +1,217 @@
+// host tester of programs/pi_chudnovsky/bn.c: random add, sub, mul, div and sqrt are checked against BigRef,
+// --bench prints ns/op by operand size
+
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+#include "bigref.h"
+#include "bnslots.h"
+#include "options.h"
+
+extern "C" {
+#include "bn.h"
+}
+
+using namespace sbc;
+
+typedef BigRef<256> Ref;
+
+// SLOT_SIZE of pi_chudnovsky/pi.c
+const size_t kSlotSize = 0x1400;
+const size_t kSlots = 10;
+// slots are filled with it before each case
+const uint8_t kJunk = 0x5A;
+
+static void usage() {
+  std::fprintf(stderr,
+    "usage: bntest [options] [add|sub|mul|div|sqrt...]\n"
+    "  --iterations N    random cases of each operation (default 2000)\n"
+    "  --max-size N      largest operand in bytes (default 200, up to 2048)\n"
+    "  --seed N          random seed (default 1)\n"
+    "  --bench           prints ns/op by operand size instead of testing\n"
+    "  --bench-ms N      time spent on each measurement (default 50)\n");
+  std::exit(2);
+}
+
+static void load(bn & dst, uint8_t * slot, const std::vector<uint8_t> & digits) {
+  dst.ptr = slot;
+  dst.used = digits.size();
+  std::copy(digits.begin(), digits.end(), slot);
+}
+
+static Ref value(const bn & src) {
+  return Ref(src.ptr, src.used);
+}
+
+class Tester {
+public:
+  Tester(uint64_t seed, size_t maxSize) : slots(kSlots, kSlotSize), rnd(seed), maxSize(maxSize) { }
+
+  unsigned failures = 0;
+
+  void run(const std::string & op) {
+    slots.clear(kJunk);
+    if (op == "add") {
+      std::vector<uint8_t> x = operand(), y = operand();
+      bn result, term;
+      load(result, slots[0], x);
+      load(term, slots[1], y);
+      bn_add(&result, &term);
+      check(op, value(result), Ref(x.data(), x.size()) + Ref(y.data(), y.size()), x, y);
+    } else if (op == "sub") {
+      std::vector<uint8_t> x = operand(), y = operand();
+      if (Ref(x.data(), x.size()) < Ref(y.data(), y.size())) {
+        std::swap(x, y);
+      }
+      // pi.c subtracts in place, bn_sub(&b, &b, &aKMult)
+      bool inPlace = rnd.below(2);
+      bn result, minuend, subtrahend;
+      load(minuend, slots[0], x);
+      load(subtrahend, slots[1], y);
+      result.ptr = inPlace ? slots[0] : slots[2];
+      bn_sub(inPlace ? &minuend : &result, &minuend, &subtrahend);
+      check(op, value(inPlace ? minuend : result), Ref(x.data(), x.size()) - Ref(y.data(), y.size()), x, y);
+    } else if (op == "mul") {
+      std::vector<uint8_t> x = operand(), y = operand();
+      bn result = { slots[0], 0 }, f1, f2, tmp = { slots[3], 0 };
+      load(f1, slots[1], x);
+      load(f2, slots[2], y);
+      bn_mul(&result, &f1, &f2, &tmp);
+      check(op, value(result), Ref(x.data(), x.size()) * Ref(y.data(), y.size()), x, y);
+    } else if (op == "div") {
+      // dividend has at least as many digits as divisor, like in computeAk() and computePi()
+      std::vector<uint8_t> y = operand();
+      std::vector<uint8_t> x = rnd.digits(y.size() + rnd.below(maxSize - y.size() + 1), 256);
+      bn quotient = { slots[0], 0 }, dividend, divisor;
+      bn tmpDivisor = { slots[3], 0 }, tmpDividend = { slots[4], 0 }, tmpRecursive = { slots[5], 0 }, tmpMult = { slots[6], 0 };
+      load(dividend, slots[1], x);
+      load(divisor, slots[2], y);
+      bn_div(&quotient, &dividend, &divisor, &tmpDivisor, &tmpDividend, &tmpRecursive, &tmpMult);
+      check(op, value(quotient), Ref(x.data(), x.size()) / Ref(y.data(), y.size()), x, y);
+    } else if (op == "sqrt") {
+      std::vector<uint8_t> x = operand();
+      bn n, root = { slots[1], 0 }, tmp0 = { slots[2], 0 }, tmp1 = { slots[3], 0 }, tmp2 = { slots[4], 0 }, tmp3 = { slots[5], 0 };
+      load(n, slots[0], x);
+      bn_sqrt(&n, &root, &tmp0, &tmp1, &tmp2, &tmp3);
+      check(op, value(root), Ref(x.data(), x.size()).isqrt(), x, {});
+    } else {
+      throw std::runtime_error("unknown operation " + op);
+    }
+  }
+
+private:
+  Slots slots;
+  Operands rnd;
+  size_t maxSize;
+
+  std::vector<uint8_t> operand() {
+    return rnd.digits(1 + rnd.below(maxSize), 256);
+  }
+
+  void check(const std::string & op, const Ref & got, const Ref & expected, const std::vector<uint8_t> & x,
+      const std::vector<uint8_t> & y) {
+    int damaged = slots.damaged();
+    if (got == expected && damaged < 0) {
+      return;
+    }
+    // only first few failures are printed in full
+    if (++failures > 5) {
+      return;
+    }
+    std::printf("%s failed%s\n  x = %s\n", op.c_str(), got == expected ? ", write out of slot" : "",
+      Ref(x.data(), x.size()).str().c_str());
+    if (!y.empty()) {
+      std::printf("  y = %s\n", Ref(y.data(), y.size()).str().c_str());
+    }
+    std::printf("  got      %s\n  expected %s\n", got.str().c_str(), expected.str().c_str());
+    if (damaged >= 0) {
+      std::printf("  guard bytes of slot %d are changed\n", damaged);
+    }
+  }
+};
+
+static void bench(double ms) {
+  Slots slots(kSlots, kSlotSize);
+  Operands rnd(1);
+  std::printf("%6s %12s %12s %12s %12s %12s\n", "bytes", "add ns", "sub ns", "mul ns", "div ns", "sqrt ns");
+  for (size_t size = 4; size <= 2048; size *= 2) {
+    std::vector<uint8_t> x = rnd.digits(size, 256), y = rnd.digits(size, 256), x2 = rnd.digits(size * 2, 256);
+    if (Ref(x.data(), x.size()) < Ref(y.data(), y.size())) {
+      std::swap(x, y);
+    }
+    bn a, b, c = { slots[2], 0 }, t3 = { slots[3], 0 }, t4 = { slots[4], 0 }, t5 = { slots[5], 0 }, t6 = { slots[6], 0 };
+
+    auto setAB = [&]() {
+      load(a, slots[0], x);
+      load(b, slots[1], y);
+    };
+    double add = nsPerOp(setAB, [&]() { bn_add(&a, &b); }, ms);
+    double sub = nsPerOp(setAB, [&]() { bn_sub(&c, &a, &b); }, ms);
+    double mul = nsPerOp(setAB, [&]() { bn_mul(&c, &a, &b, &t3); }, ms);
+    // 2n by n digits
+    auto setDiv = [&]() {
+      load(a, slots[0], x2);
+      load(b, slots[1], y);
+    };
+    double div = nsPerOp(setDiv, [&]() { bn_div(&c, &a, &b, &t3, &t4, &t5, &t6); }, ms);
+    auto setSqrt = [&]() {
+      load(a, slots[0], x2);
+    };
+    double sqrt = nsPerOp(setSqrt, [&]() { bn_sqrt(&a, &c, &t3, &t4, &t5, &t6); }, ms);
+    std::printf("%6zu %12.1f %12.1f %12.1f %12.1f %12.1f\n", size, add, sub, mul, div, sqrt);
+  }
+}
+
+int main(int argc, char ** argv) {
+  Options options(argc, argv);
+  uint64_t iterations = 2000, seed = 1, maxSize = 200, benchMs = 50;
+  bool doBench = false;
+  std::set<std::string> ops;
+  try {
+    while (options.next()) {
+      if (options.is("--iterations")) {
+        iterations = options.number();
+      } else if (options.is("--max-size")) {
+        maxSize = options.number();
+      } else if (options.is("--seed")) {
+        seed = options.number();
+      } else if (options.is("--bench")) {
+        doBench = true;
+      } else if (options.is("--bench-ms")) {
+        benchMs = options.number();
+      } else if (options.isPositional()) {
+        ops.insert(options.current());
+      } else {
+        usage();
+      }
+    }
+    if (maxSize < 1 || maxSize > 2048) {
+      usage();
+    }
+    if (doBench) {
+      bench(benchMs);
+      return 0;
+    }
+    if (ops.empty()) {
+      ops = { "add", "sub", "mul", "div", "sqrt" };
+    }
+
+    Tester tester(seed, maxSize);
+    bool ok = true;
+    for (const std::string & op : ops) {
+      tester.failures = 0;
+      for (uint64_t i = 0; i < iterations; i++) {
+        tester.run(op);
+      }
+      std::printf("%-5s %llu cases, %u failed\n", op.c_str(), (unsigned long long)iterations, tester.failures);
+      ok &= tester.failures == 0;
+    }
+    return ok ? 0 : 1;
+  } catch (const std::exception & e) {
+    std::fprintf(stderr, "bntest: %s\n", e.what());
+    return 2;
+  }
+}
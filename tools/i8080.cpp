@@ -0,0 +1,127 @@
+#include "i8080.h"
+
+namespace sbc {
+
+uint8_t Cpu::psw() const {
+  return (sf << 7) | (zf << 6) | (hf << 4) | (pf << 2) | 0x02 | cf;
+}
+
+void Cpu::setPsw(uint8_t v) {
+  sf = v & 0x80;
+  zf = v & 0x40;
+  hf = v & 0x10;
+  pf = v & 0x04;
+  cf = v & 0x01;
+}
+
+const uint8_t kCycles[256] = {
+  4, 10,  7,  5,  5,  5,  7,  4,  4, 10,  7,  5,  5,  5,  7,  4,
+  4, 10,  7,  5,  5,  5,  7,  4,  4, 10,  7,  5,  5,  5,  7,  4,
+  4, 10, 16,  5,  5,  5,  7,  4,  4, 10, 16,  5,  5,  5,  7,  4,
+  4, 10, 13,  5, 10, 10, 10,  4,  4, 10, 13,  5,  5,  5,  7,  4,
+  5,  5,  5,  5,  5,  5,  7,  5,  5,  5,  5,  5,  5,  5,  7,  5,
+  5,  5,  5,  5,  5,  5,  7,  5,  5,  5,  5,  5,  5,  5,  7,  5,
+  5,  5,  5,  5,  5,  5,  7,  5,  5,  5,  5,  5,  5,  5,  7,  5,
+  7,  7,  7,  7,  7,  7,  7,  7,  5,  5,  5,  5,  5,  5,  7,  5,
+  4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+  4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+  4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+  4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+  5, 10, 10, 10, 11, 11,  7, 11,  5, 10, 10, 10, 11, 17,  7, 11,
+  5, 10, 10, 10, 11, 11,  7, 11,  5, 10, 10, 10, 11, 17,  7, 11,
+  5, 10, 10, 18, 11, 11,  7, 11,  5,  5, 10,  4, 11, 17,  7, 11,
+  5, 10, 10,  4, 11, 11,  7, 11,  5,  5, 10,  4, 11, 17,  7, 11,
+};
+
+const uint8_t kLengths[256] = {
+  1, 3, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 1,
+  1, 3, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 1,
+  1, 3, 3, 1, 1, 1, 2, 1, 1, 1, 3, 1, 1, 1, 2, 1,
+  1, 3, 3, 1, 1, 1, 2, 1, 1, 1, 3, 1, 1, 1, 2, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 3, 3, 3, 1, 2, 1, 1, 1, 3, 3, 3, 3, 2, 1,
+  1, 1, 3, 2, 3, 1, 2, 1, 1, 1, 3, 2, 3, 3, 2, 1,
+  1, 1, 3, 1, 3, 1, 2, 1, 1, 1, 3, 1, 3, 3, 2, 1,
+  1, 1, 3, 1, 3, 1, 2, 1, 1, 1, 3, 1, 3, 3, 2, 1,
+};
+
+// undocumented opcodes are marked with '*'
+const char * const kMnemonics[256] = {
+  "NOP", "LXI B,nn", "STAX B", "INX B", "INR B", "DCR B", "MVI B,n", "RLC",
+  "*NOP", "DAD B", "LDAX B", "DCX B", "INR C", "DCR C", "MVI C,n", "RRC",
+  "*NOP", "LXI D,nn", "STAX D", "INX D", "INR D", "DCR D", "MVI D,n", "RAL",
+  "*NOP", "DAD D", "LDAX D", "DCX D", "INR E", "DCR E", "MVI E,n", "RAR",
+  "*NOP", "LXI H,nn", "SHLD nn", "INX H", "INR H", "DCR H", "MVI H,n", "DAA",
+  "*NOP", "DAD H", "LHLD nn", "DCX H", "INR L", "DCR L", "MVI L,n", "CMA",
+  "*NOP", "LXI SP,nn", "STA nn", "INX SP", "INR M", "DCR M", "MVI M,n", "STC",
+  "*NOP", "DAD SP", "LDA nn", "DCX SP", "INR A", "DCR A", "MVI A,n", "CMC",
+  "MOV B,B", "MOV B,C", "MOV B,D", "MOV B,E", "MOV B,H", "MOV B,L", "MOV B,M", "MOV B,A",
+  "MOV C,B", "MOV C,C", "MOV C,D", "MOV C,E", "MOV C,H", "MOV C,L", "MOV C,M", "MOV C,A",
+  "MOV D,B", "MOV D,C", "MOV D,D", "MOV D,E", "MOV D,H", "MOV D,L", "MOV D,M", "MOV D,A",
+  "MOV E,B", "MOV E,C", "MOV E,D", "MOV E,E", "MOV E,H", "MOV E,L", "MOV E,M", "MOV E,A",
+  "MOV H,B", "MOV H,C", "MOV H,D", "MOV H,E", "MOV H,H", "MOV H,L", "MOV H,M", "MOV H,A",
+  "MOV L,B", "MOV L,C", "MOV L,D", "MOV L,E", "MOV L,H", "MOV L,L", "MOV L,M", "MOV L,A",
+  "MOV M,B", "MOV M,C", "MOV M,D", "MOV M,E", "MOV M,H", "MOV M,L", "HLT", "MOV M,A",
+  "MOV A,B", "MOV A,C", "MOV A,D", "MOV A,E", "MOV A,H", "MOV A,L", "MOV A,M", "MOV A,A",
+  "ADD B", "ADD C", "ADD D", "ADD E", "ADD H", "ADD L", "ADD M", "ADD A",
+  "ADC B", "ADC C", "ADC D", "ADC E", "ADC H", "ADC L", "ADC M", "ADC A",
+  "SUB B", "SUB C", "SUB D", "SUB E", "SUB H", "SUB L", "SUB M", "SUB A",
+  "SBB B", "SBB C", "SBB D", "SBB E", "SBB H", "SBB L", "SBB M", "SBB A",
+  "ANA B", "ANA C", "ANA D", "ANA E", "ANA H", "ANA L", "ANA M", "ANA A",
+  "XRA B", "XRA C", "XRA D", "XRA E", "XRA H", "XRA L", "XRA M", "XRA A",
+  "ORA B", "ORA C", "ORA D", "ORA E", "ORA H", "ORA L", "ORA M", "ORA A",
+  "CMP B", "CMP C", "CMP D", "CMP E", "CMP H", "CMP L", "CMP M", "CMP A",
+  "RNZ", "POP B", "JNZ nn", "JMP nn", "CNZ nn", "PUSH B", "ADI n", "RST 0",
+  "RZ", "RET", "JZ nn", "*JMP nn", "CZ nn", "CALL nn", "ACI n", "RST 1",
+  "RNC", "POP D", "JNC nn", "OUT n", "CNC nn", "PUSH D", "SUI n", "RST 2",
+  "RC", "*RET", "JC nn", "IN n", "CC nn", "*CALL nn", "SBI n", "RST 3",
+  "RPO", "POP H", "JPO nn", "XTHL", "CPO nn", "PUSH H", "ANI n", "RST 4",
+  "RPE", "PCHL", "JPE nn", "XCHG", "CPE nn", "*CALL nn", "XRI n", "RST 5",
+  "RP", "POP PSW", "JP nn", "DI", "CP nn", "PUSH PSW", "ORI n", "RST 6",
+  "RM", "SPHL", "JM nn", "EI", "CM nn", "*CALL nn", "CPI n", "RST 7",
+};
+
+// true for even number of set bits
+const bool kParity[256] = {
+  true, false, false, true, false, true, true, false,
+  false, true, true, false, true, false, false, true,
+  false, true, true, false, true, false, false, true,
+  true, false, false, true, false, true, true, false,
+  false, true, true, false, true, false, false, true,
+  true, false, false, true, false, true, true, false,
+  true, false, false, true, false, true, true, false,
+  false, true, true, false, true, false, false, true,
+  false, true, true, false, true, false, false, true,
+  true, false, false, true, false, true, true, false,
+  true, false, false, true, false, true, true, false,
+  false, true, true, false, true, false, false, true,
+  true, false, false, true, false, true, true, false,
+  false, true, true, false, true, false, false, true,
+  false, true, true, false, true, false, false, true,
+  true, false, false, true, false, true, true, false,
+  false, true, true, false, true, false, false, true,
+  true, false, false, true, false, true, true, false,
+  true, false, false, true, false, true, true, false,
+  false, true, true, false, true, false, false, true,
+  true, false, false, true, false, true, true, false,
+  false, true, true, false, true, false, false, true,
+  false, true, true, false, true, false, false, true,
+  true, false, false, true, false, true, true, false,
+  true, false, false, true, false, true, true, false,
+  false, true, true, false, true, false, false, true,
+  false, true, true, false, true, false, false, true,
+  true, false, false, true, false, true, true, false,
+  false, true, true, false, true, false, false, true,
+  true, false, false, true, false, true, true, false,
+  true, false, false, true, false, true, true, false,
+  false, true, true, false, true, false, false, true,
+};
+
+}
@@ -0,0 +1,468 @@
+#ifndef __SBC_I8080_H__
+#define __SBC_I8080_H__
+
+#include <cstdint>
+
+namespace sbc {
+
+// registers and flags of i8080, flags are kept unpacked and packed only by PUSH PSW
+struct Cpu {
+  uint8_t a = 0, b = 0, c = 0, d = 0, e = 0, h = 0, l = 0;
+  bool sf = false, zf = false, hf = false, pf = false, cf = false;
+  uint16_t pc = 0, sp = 0;
+  bool inte = false;
+  // EI enables interrupts only after the next instruction
+  bool eiDelay = false;
+  bool halted = false;
+  uint64_t cycles = 0;
+
+  uint16_t bc() const { return (b << 8) | c; }
+  uint16_t de() const { return (d << 8) | e; }
+  uint16_t hl() const { return (h << 8) | l; }
+  void setBc(uint16_t v) { b = v >> 8; c = v; }
+  void setDe(uint16_t v) { d = v >> 8; e = v; }
+  void setHl(uint16_t v) { h = v >> 8; l = v; }
+
+  uint8_t psw() const;
+  void setPsw(uint8_t v);
+};
+
+// cycles of every opcode from Intel 8080 datasheet, conditional CALL and RET have not taken value,
+// taken one is 6 cycles more
+extern const uint8_t kCycles[256];
+
+// extra cycles of taken conditional CALL and RET
+const unsigned kTakenExtra = 6;
+
+// interrupt acknowledge with RST n
+const unsigned kInterruptCycles = 11;
+
+// mnemonic of every opcode, operands are given in 8080 syntax, e.g. "MOV A,M", "LXI H,nn"
+extern const char * const kMnemonics[256];
+
+// length of every opcode in bytes
+extern const uint8_t kLengths[256];
+
+extern const bool kParity[256];
+
+namespace alu {
+
+inline void szp(Cpu & cpu, uint8_t v) {
+  cpu.sf = v & 0x80;
+  cpu.zf = v == 0;
+  cpu.pf = kParity[v];
+}
+
+inline void add(Cpu & cpu, uint8_t v, bool carry) {
+  unsigned r = cpu.a + v + carry;
+  cpu.hf = (cpu.a ^ v ^ r) & 0x10;
+  cpu.cf = r > 0xFF;
+  cpu.a = r;
+  szp(cpu, cpu.a);
+}
+
+// subtraction is addition of complement, 8080 leaves AC as carry of that addition, CY as borrow
+inline uint8_t sub(Cpu & cpu, uint8_t v, bool borrow) {
+  uint8_t n = ~v;
+  unsigned r = cpu.a + n + !borrow;
+  cpu.hf = (cpu.a ^ n ^ r) & 0x10;
+  cpu.cf = r <= 0xFF;
+  szp(cpu, r);
+  return r;
+}
+
+inline void ana(Cpu & cpu, uint8_t v) {
+  cpu.hf = (cpu.a | v) & 0x08;
+  cpu.cf = false;
+  cpu.a &= v;
+  szp(cpu, cpu.a);
+}
+
+inline void xra(Cpu & cpu, uint8_t v) {
+  cpu.hf = cpu.cf = false;
+  cpu.a ^= v;
+  szp(cpu, cpu.a);
+}
+
+inline void ora(Cpu & cpu, uint8_t v) {
+  cpu.hf = cpu.cf = false;
+  cpu.a |= v;
+  szp(cpu, cpu.a);
+}
+
+// ALU operation by bits 3..5 of opcode: ADD, ADC, SUB, SBB, ANA, XRA, ORA, CMP
+inline void op(Cpu & cpu, unsigned n, uint8_t v) {
+  switch (n) {
+    case 0: add(cpu, v, false); break;
+    case 1: add(cpu, v, cpu.cf); break;
+    case 2: cpu.a = sub(cpu, v, false); break;
+    case 3: cpu.a = sub(cpu, v, cpu.cf); break;
+    case 4: ana(cpu, v); break;
+    case 5: xra(cpu, v); break;
+    case 6: ora(cpu, v); break;
+    default: sub(cpu, v, false); break;
+  }
+}
+
+inline uint8_t inr(Cpu & cpu, uint8_t v) {
+  v++;
+  cpu.hf = (v & 0x0F) == 0;
+  szp(cpu, v);
+  return v;
+}
+
+inline uint8_t dcr(Cpu & cpu, uint8_t v) {
+  v--;
+  cpu.hf = (v & 0x0F) != 0x0F;
+  szp(cpu, v);
+  return v;
+}
+
+inline void daa(Cpu & cpu) {
+  bool carry = cpu.cf;
+  uint8_t correction = 0;
+  uint8_t lsb = cpu.a & 0x0F;
+  uint8_t msb = cpu.a >> 4;
+  if (cpu.hf || lsb > 9) {
+    correction += 0x06;
+  }
+  if (cpu.cf || msb > 9 || (msb >= 9 && lsb > 9)) {
+    correction += 0x60;
+    carry = true;
+  }
+  add(cpu, correction, false);
+  cpu.cf = carry;
+}
+
+inline void dad(Cpu & cpu, uint16_t v) {
+  unsigned r = cpu.hl() + v;
+  cpu.cf = r > 0xFFFF;
+  cpu.setHl(r);
+}
+
+// condition by bits 3..5 of opcode: NZ, Z, NC, C, PO, PE, P, M
+inline bool cond(const Cpu & cpu, unsigned n) {
+  switch (n) {
+    case 0: return !cpu.zf;
+    case 1: return cpu.zf;
+    case 2: return !cpu.cf;
+    case 3: return cpu.cf;
+    case 4: return !cpu.pf;
+    case 5: return cpu.pf;
+    case 6: return !cpu.sf;
+    default: return cpu.sf;
+  }
+}
+
+}
+
+// Bus provides uint8_t fetch(uint16_t) for opcode and operand bytes, uint8_t read(uint16_t),
+// void write(uint16_t, uint8_t), uint8_t in(uint8_t) and void out(uint8_t, uint8_t), cpu.cycles is advanced after the instruction is done,
+// so bus sees cycle count of instruction start
+template <class Bus>
+class Core {
+public:
+  Core(Cpu & cpu, Bus & bus) : cpu(cpu), bus(bus) { }
+
+  // executes one instruction (or 4 idle cycles of HLT state), returns its cycles
+  unsigned step() {
+    if (cpu.halted) {
+      cpu.cycles += 4;
+      return 4;
+    }
+    cpu.eiDelay = false;
+    uint8_t opcode = fetch8();
+    unsigned cycles = kCycles[opcode] + execute(opcode);
+    cpu.cycles += cycles;
+    return cycles;
+  }
+
+  // RST n from interrupting device, ignored while interrupts are disabled or EI is pending
+  bool interrupt(uint8_t rst) {
+    if (!cpu.inte || cpu.eiDelay) {
+      return false;
+    }
+    cpu.inte = false;
+    cpu.halted = false;
+    push16(cpu.pc);
+    cpu.pc = rst * 8;
+    cpu.cycles += kInterruptCycles;
+    return true;
+  }
+
+private:
+  Cpu & cpu;
+  Bus & bus;
+
+  uint8_t fetch8() {
+    return bus.fetch(cpu.pc++);
+  }
+
+  uint16_t fetch16() {
+    uint8_t lo = fetch8();
+    return lo | (fetch8() << 8);
+  }
+
+  uint16_t read16(uint16_t addr) {
+    uint8_t lo = bus.read(addr);
+    return lo | (bus.read(addr + 1) << 8);
+  }
+
+  void write16(uint16_t addr, uint16_t v) {
+    bus.write(addr, v);
+    bus.write(addr + 1, v >> 8);
+  }
+
+  void push16(uint16_t v) {
+    cpu.sp -= 2;
+    write16(cpu.sp, v);
+  }
+
+  uint16_t pop16() {
+    uint16_t v = read16(cpu.sp);
+    cpu.sp += 2;
+    return v;
+  }
+
+  // register by 3-bit code: B, C, D, E, H, L, M, A
+  uint8_t reg(unsigned n) {
+    switch (n) {
+      case 0: return cpu.b;
+      case 1: return cpu.c;
+      case 2: return cpu.d;
+      case 3: return cpu.e;
+      case 4: return cpu.h;
+      case 5: return cpu.l;
+      case 6: return bus.read(cpu.hl());
+      default: return cpu.a;
+    }
+  }
+
+  void setReg(unsigned n, uint8_t v) {
+    switch (n) {
+      case 0: cpu.b = v; break;
+      case 1: cpu.c = v; break;
+      case 2: cpu.d = v; break;
+      case 3: cpu.e = v; break;
+      case 4: cpu.h = v; break;
+      case 5: cpu.l = v; break;
+      case 6: bus.write(cpu.hl(), v); break;
+      default: cpu.a = v; break;
+    }
+  }
+
+  // register pair by 2-bit code: BC, DE, HL, SP
+  uint16_t pair(unsigned n) {
+    switch (n) {
+      case 0: return cpu.bc();
+      case 1: return cpu.de();
+      case 2: return cpu.hl();
+      default: return cpu.sp;
+    }
+  }
+
+  void setPair(unsigned n, uint16_t v) {
+    switch (n) {
+      case 0: cpu.setBc(v); break;
+      case 1: cpu.setDe(v); break;
+      case 2: cpu.setHl(v); break;
+      default: cpu.sp = v; break;
+    }
+  }
+
+  // returns extra cycles of taken conditional CALL and RET
+  unsigned execute(uint8_t opcode) {
+    if (opcode >= 0x40 && opcode < 0x80 && opcode != 0x76) {
+      setReg((opcode >> 3) & 7, reg(opcode & 7));
+      return 0;
+    }
+    if (opcode >= 0x80 && opcode < 0xC0) {
+      alu::op(cpu, (opcode >> 3) & 7, reg(opcode & 7));
+      return 0;
+    }
+    switch (opcode) {
+      // NOP and its undocumented copies
+      case 0x00: case 0x08: case 0x10: case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:
+        return 0;
+
+      // LXI
+      case 0x01: case 0x11: case 0x21: case 0x31:
+        setPair(opcode >> 4, fetch16());
+        return 0;
+
+      // STAX, LDAX
+      case 0x02: bus.write(cpu.bc(), cpu.a); return 0;
+      case 0x12: bus.write(cpu.de(), cpu.a); return 0;
+      case 0x0A: cpu.a = bus.read(cpu.bc()); return 0;
+      case 0x1A: cpu.a = bus.read(cpu.de()); return 0;
+
+      // INX, DCX, DAD
+      case 0x03: case 0x13: case 0x23: case 0x33:
+        setPair(opcode >> 4, pair(opcode >> 4) + 1);
+        return 0;
+      case 0x0B: case 0x1B: case 0x2B: case 0x3B:
+        setPair(opcode >> 4, pair(opcode >> 4) - 1);
+        return 0;
+      case 0x09: case 0x19: case 0x29: case 0x39:
+        alu::dad(cpu, pair(opcode >> 4));
+        return 0;
+
+      // INR, DCR, MVI
+      case 0x04: case 0x0C: case 0x14: case 0x1C: case 0x24: case 0x2C: case 0x34: case 0x3C:
+        setReg(opcode >> 3, alu::inr(cpu, reg(opcode >> 3)));
+        return 0;
+      case 0x05: case 0x0D: case 0x15: case 0x1D: case 0x25: case 0x2D: case 0x35: case 0x3D:
+        setReg(opcode >> 3, alu::dcr(cpu, reg(opcode >> 3)));
+        return 0;
+      case 0x06: case 0x0E: case 0x16: case 0x1E: case 0x26: case 0x2E: case 0x36: case 0x3E:
+        setReg(opcode >> 3, fetch8());
+        return 0;
+
+      // rotations
+      case 0x07:
+        cpu.cf = cpu.a >> 7;
+        cpu.a = (cpu.a << 1) | cpu.cf;
+        return 0;
+      case 0x0F:
+        cpu.cf = cpu.a & 1;
+        cpu.a = (cpu.a >> 1) | (cpu.cf << 7);
+        return 0;
+      case 0x17: {
+        bool carry = cpu.a >> 7;
+        cpu.a = (cpu.a << 1) | cpu.cf;
+        cpu.cf = carry;
+        return 0;
+      }
+      case 0x1F: {
+        bool carry = cpu.a & 1;
+        cpu.a = (cpu.a >> 1) | (cpu.cf << 7);
+        cpu.cf = carry;
+        return 0;
+      }
+
+      case 0x22: write16(fetch16(), cpu.hl()); return 0;
+      case 0x2A: cpu.setHl(read16(fetch16())); return 0;
+      case 0x32: bus.write(fetch16(), cpu.a); return 0;
+      case 0x3A: cpu.a = bus.read(fetch16()); return 0;
+
+      case 0x27: alu::daa(cpu); return 0;
+      case 0x2F: cpu.a = ~cpu.a; return 0;
+      case 0x37: cpu.cf = true; return 0;
+      case 0x3F: cpu.cf = !cpu.cf; return 0;
+
+      case 0x76:
+        cpu.halted = true;
+        return 0;
+
+      // Rcc
+      case 0xC0: case 0xC8: case 0xD0: case 0xD8: case 0xE0: case 0xE8: case 0xF0: case 0xF8:
+        if (alu::cond(cpu, (opcode >> 3) & 7)) {
+          cpu.pc = pop16();
+          return kTakenExtra;
+        }
+        return 0;
+
+      // POP
+      case 0xC1: case 0xD1: case 0xE1:
+        setPair((opcode >> 4) & 3, pop16());
+        return 0;
+      case 0xF1: {
+        uint16_t v = pop16();
+        cpu.a = v >> 8;
+        cpu.setPsw(v);
+        return 0;
+      }
+
+      // Jcc
+      case 0xC2: case 0xCA: case 0xD2: case 0xDA: case 0xE2: case 0xEA: case 0xF2: case 0xFA: {
+        uint16_t addr = fetch16();
+        if (alu::cond(cpu, (opcode >> 3) & 7)) {
+          cpu.pc = addr;
+        }
+        return 0;
+      }
+
+      // JMP and its undocumented copy
+      case 0xC3: case 0xCB:
+        cpu.pc = fetch16();
+        return 0;
+
+      // Ccc
+      case 0xC4: case 0xCC: case 0xD4: case 0xDC: case 0xE4: case 0xEC: case 0xF4: case 0xFC: {
+        uint16_t addr = fetch16();
+        if (alu::cond(cpu, (opcode >> 3) & 7)) {
+          push16(cpu.pc);
+          cpu.pc = addr;
+          return kTakenExtra;
+        }
+        return 0;
+      }
+
+      // PUSH
+      case 0xC5: case 0xD5: case 0xE5:
+        push16(pair((opcode >> 4) & 3));
+        return 0;
+      case 0xF5:
+        push16((cpu.a << 8) | cpu.psw());
+        return 0;
+
+      // ALU with immediate operand
+      case 0xC6: case 0xCE: case 0xD6: case 0xDE: case 0xE6: case 0xEE: case 0xF6: case 0xFE:
+        alu::op(cpu, (opcode >> 3) & 7, fetch8());
+        return 0;
+
+      // RST
+      case 0xC7: case 0xCF: case 0xD7: case 0xDF: case 0xE7: case 0xEF: case 0xF7: case 0xFF:
+        push16(cpu.pc);
+        cpu.pc = opcode & 0x38;
+        return 0;
+
+      // RET and its undocumented copy
+      case 0xC9: case 0xD9:
+        cpu.pc = pop16();
+        return 0;
+
+      // CALL and its undocumented copies
+      case 0xCD: case 0xDD: case 0xED: case 0xFD: {
+        uint16_t addr = fetch16();
+        push16(cpu.pc);
+        cpu.pc = addr;
+        return 0;
+      }
+
+      case 0xD3: {
+        uint8_t port = fetch8();
+        bus.out(port, cpu.a);
+        return 0;
+      }
+      case 0xDB:
+        cpu.a = bus.in(fetch8());
+        return 0;
+
+      case 0xE3: {
+        uint16_t v = read16(cpu.sp);
+        write16(cpu.sp, cpu.hl());
+        cpu.setHl(v);
+        return 0;
+      }
+      case 0xE9: cpu.pc = cpu.hl(); return 0;
+      case 0xEB: {
+        uint16_t v = cpu.de();
+        cpu.setDe(cpu.hl());
+        cpu.setHl(v);
+        return 0;
+      }
+      case 0xF3: cpu.inte = false; return 0;
+      case 0xF9: cpu.sp = cpu.hl(); return 0;
+      case 0xFB:
+        cpu.inte = true;
+        cpu.eiDelay = true;
+        return 0;
+    }
+    return 0;
+  }
+};
+
+}
+
+#endif
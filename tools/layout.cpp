@@ -0,0 +1,67 @@
+#include "layout.h"
+
+#include <cstdio>
+
+#include "../shared/memmap.h"
+
+namespace sbc {
+
+static std::string hex(uint32_t v) {
+  char buf[8];
+  std::snprintf(buf, sizeof(buf), "0x%04X", v);
+  return buf;
+}
+
+std::vector<std::string> checkLayout(const MapFile & map) {
+  struct Constant {
+    const char * name;
+    uint32_t value;
+  };
+  static const Constant constants[] = {
+    { "MEM_CODE_START", MEM_CODE_START },
+    { "MEM_CODE_END", MEM_CODE_END },
+    { "MEM_DATA_START", MEM_DATA_START },
+    { "MEM_DATA_END", MEM_DATA_END },
+    { "MEM_SMALL_START", MEM_SMALL_START },
+    { "MEM_SMALL_END", MEM_SMALL_END },
+    { "MEM_SMALL_SIZE", MEM_SMALL_SIZE },
+    { "MEM_TICKS", MEM_TICKS },
+    { "MEM_TICKS_SIZE", MEM_TICKS_SIZE },
+    { "MEM_STACK_LIMIT", MEM_STACK_LIMIT },
+    { "MEM_STACK_TOP", MEM_STACK_TOP },
+  };
+
+  std::vector<std::string> problems;
+  for (const Constant & constant : constants) {
+    const Symbol * symbol = map.find(constant.name);
+    if (symbol != nullptr && symbol->value != constant.value) {
+      problems.push_back(std::string(constant.name) + " is " + hex(symbol->value) + " in memmap.inc and "
+        + hex(constant.value) + " in memmap.h");
+    }
+  }
+
+  uint32_t limit = MEM_DATA_END;
+  if (const Symbol * imageEnd = map.find("__IMAGE_END")) {
+    limit = imageEnd->value;
+    if (limit > MEM_DATA_END) {
+      problems.push_back("__IMAGE_END " + hex(limit) + " is above data region end " + hex(MEM_DATA_END));
+    }
+  }
+  const Symbol * end = map.find("__BSS_END_tail");
+  if (end == nullptr) {
+    end = map.find("__tail");
+  }
+  if (end != nullptr && end->value > limit) {
+    problems.push_back("image ends at " + hex(end->value) + ", above its limit " + hex(limit)
+      + (map.find("__IMAGE_END") ? " (__IMAGE_END)" : " (MEM_DATA_END)"));
+  }
+
+  const Symbol * sp = map.find("__register_sp");
+  if (sp != nullptr && sp->value != MEM_STACK_TOP) {
+    problems.push_back("stack starts at " + hex(sp->value) + ", not at MEM_STACK_TOP " + hex(MEM_STACK_TOP)
+      + " above small number slots");
+  }
+  return problems;
+}
+
+}
@@ -0,0 +1,23 @@
+#ifndef __SBC_LAYOUT_H__
+#define __SBC_LAYOUT_H__
+
+#include <string>
+#include <vector>
+
+#include "mapfile.h"
+
+namespace sbc {
+
+// checks linked image against shared/memmap.h, memmap.h checks compare constants only:
+//   image end (__BSS_END_tail, __tail for .map without BSS_END section) isn't above __IMAGE_END of
+//   8080_crt.asm, MEM_DATA_END for images linked before CRT exported it, and __IMAGE_END isn't above
+//   MEM_DATA_END
+//   stack starts at MEM_STACK_TOP (__register_sp), so it grows down towards MEM_STACK_LIMIT above
+//   small number slots
+//   MEM_ constants of memmap.inc linked into image have the same values as memmap.h
+// returns one message per problem, empty if image fits
+std::vector<std::string> checkLayout(const MapFile & map);
+
+}
+
+#endif
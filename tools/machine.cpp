@@ -0,0 +1,79 @@
+#include "machine.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace sbc {
+
+const char * stopName(Stop stop) {
+  switch (stop) {
+    case Stop::Halt: return "halt";
+    case Stop::Address: return "stop address";
+    case Stop::Pause: return "pause";
+    default: return "cycle limit";
+  }
+}
+
+// Intel HEX with data (00) and end of file (01) records
+static void loadHex(const std::string & text, uint8_t * mem, const std::string & path) {
+  size_t pos = 0;
+  while ((pos = text.find(':', pos)) != std::string::npos) {
+    auto byteAt = [&](size_t i) {
+      if (pos + 1 + i * 2 + 2 > text.size()) {
+        throw std::runtime_error("truncated record in " + path);
+      }
+      return (uint8_t)std::stoul(text.substr(pos + 1 + i * 2, 2), nullptr, 16);
+    };
+    uint8_t count = byteAt(0);
+    uint16_t addr = (byteAt(1) << 8) | byteAt(2);
+    uint8_t type = byteAt(3);
+    if (type == 0x01) {
+      return;
+    }
+    if (type == 0x00) {
+      for (unsigned i = 0; i < count; i++) {
+        mem[(uint16_t)(addr + i)] = byteAt(4 + i);
+      }
+    }
+    pos += 1 + (count + 5) * 2;
+  }
+}
+
+void Machine::load(const std::string & path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("can't open " + path);
+  }
+  std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  size_t dot = path.rfind('.');
+  std::string ext = dot == std::string::npos ? "" : path.substr(dot);
+  if (ext == ".ihx" || ext == ".hex") {
+    loadHex(data, mem, path);
+    return;
+  }
+  if (data.size() > sizeof(mem)) {
+    throw std::runtime_error(path + " doesn't fit 64Kb");
+  }
+  std::copy(data.begin(), data.end(), mem);
+}
+
+void Machine::out(uint8_t port, uint8_t v) {
+  if (port == kConsolePort) {
+    txUsed = true;
+    txReadyAt = cpu.cycles + config.txCycles;
+    if (v == kMarker) {
+      markers.push_back(cpu.cycles);
+    } else {
+      output.push_back(v);
+      if (config.echo) {
+        std::fputc(v, stdout);
+      }
+    }
+  }
+  // marker and transmitter see cycles of OUT start, latency of port follows them
+  cpu.cycles += config.outWait[port];
+}
+
+}
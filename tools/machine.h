@@ -0,0 +1,236 @@
+#ifndef __SBC_MACHINE_H__
+#define __SBC_MACHINE_H__
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "i8080.h"
+#include "../shared/memmap.h"
+
+namespace sbc {
+
+const uint16_t kTicksAddr = MEM_TICKS;
+const unsigned kTicksSize = MEM_TICKS_SIZE;
+const uint16_t kRomEnd = MEM_CODE_END;
+// same value as __CPU_CLOCK of 8080_crt.asm
+const uint32_t kCpuClock = 3125000;
+
+// console port, 0x05 written to it is timing marker, not a character
+const uint8_t kConsolePort = 1;
+const uint8_t kMarker = 0x05;
+
+enum class Stop {
+  Halt,
+  Address,
+  CycleLimit,
+  // config.pauseAddr or config.pauseMarker is reached, run can be continued
+  Pause,
+};
+
+const char * stopName(Stop stop);
+
+struct Config {
+  uint32_t cpuHz = kCpuClock;
+  // tick counter frequency, on the board it is the CPU clock
+  uint32_t tickHz = kCpuClock;
+  // transmitter raises RST 7 when it is idle, needed by CONS_FIFO builds of hal.asm
+  bool txIrq = false;
+  // cycles transmitter stays busy after OUT to console port
+  unsigned txCycles = 0;
+  // PC that stops execution, normally "cleanup" from .map file, -1 if none
+  int stopAddr = -1;
+  // PC that pauses execution, -1 if none, and number of marker (1 is the first one) that pauses it
+  // right after its OUT, 0 if none; they are used to take snapshots
+  int pauseAddr = -1;
+  unsigned pauseMarker = 0;
+  // console bytes are copied to stdout as they come
+  bool echo = false;
+
+  // timing of the board above datasheet cycles: wait states of every memory access (opcode and operand
+  // fetches, data reads and writes) by region, ROM image is below romEnd, tick counter bytes have their
+  // own value, other addresses are RAM; cycles every OUT to port takes in addition; tick counter value
+  // when CPU starts. Values are fitted by sbccal, all are 0 by default
+  uint16_t romEnd = kRomEnd;
+  unsigned romWait = 0;
+  unsigned ramWait = 0;
+  unsigned ticksWait = 0;
+  std::array<uint8_t, 256> outWait = { };
+  uint64_t tickOffset = 0;
+};
+
+struct NoHook {
+  void step(uint16_t, uint16_t, uint8_t, unsigned, const Cpu &) { }
+  void interrupt(uint16_t, const Cpu &) { }
+};
+
+struct NoAccess {
+  void fetch(uint16_t) { }
+  void read(uint16_t) { }
+  void write(uint16_t) { }
+};
+
+// i8080-sbc: 64Kb of RAM loaded with program image at 0, read-only 40-bit tick counter at 0xF880
+// counting CPU cycles, console output on port 1
+class Machine {
+public:
+  Cpu cpu;
+  uint8_t mem[0x10000] = { };
+  Config config;
+
+  // console output without markers
+  std::string output;
+  // cycle count at each marker OUT instruction
+  std::vector<uint64_t> markers;
+
+  explicit Machine(const Config & config = Config()) : config(config) { }
+
+  // throws std::runtime_error if image can't be loaded
+  void load(const std::string & path);
+
+  uint64_t ticks() const {
+    uint64_t t = config.tickHz == config.cpuHz ? cpu.cycles : cpu.cycles * config.tickHz / config.cpuHz;
+    return (t + config.tickOffset) & 0xFFFFFFFFFFULL;
+  }
+
+  // wait states of one access to addr
+  unsigned waitStates(uint16_t addr) const {
+    if ((uint16_t)(addr - kTicksAddr) < kTicksSize) {
+      return config.ticksWait;
+    }
+    return addr < config.romEnd ? config.romWait : config.ramWait;
+  }
+
+  uint8_t fetch(uint16_t addr) const {
+    return read(addr);
+  }
+
+  uint8_t read(uint16_t addr) const {
+    if ((uint16_t)(addr - kTicksAddr) < kTicksSize) {
+      return ticks() >> ((addr - kTicksAddr) * 8);
+    }
+    return mem[addr];
+  }
+
+  void write(uint16_t addr, uint8_t v) {
+    if ((uint16_t)(addr - kTicksAddr) >= kTicksSize) {
+      mem[addr] = v;
+    }
+  }
+
+  uint8_t in(uint8_t) {
+    return 0xFF;
+  }
+
+  void out(uint8_t port, uint8_t v);
+
+  // true when run should pause at PC
+  bool pausePending(uint16_t pc) const {
+    return pc == config.pauseAddr || (config.pauseMarker != 0 && markers.size() == config.pauseMarker);
+  }
+
+  // runs until HLT with interrupts disabled, PC == config.stopAddr, pause or maxCycles
+  Stop run(uint64_t maxCycles) {
+    NoHook hook;
+    return run(maxCycles, hook);
+  }
+
+  // same, hook.step(pc, sp, opcode, cycles, cpu) is called after every instruction with PC and SP
+  // it started with, hook.interrupt(pc, cpu) after interrupt is taken with PC it has interrupted
+  template <class Hook>
+  Stop run(uint64_t maxCycles, Hook & hook) {
+    NoAccess access;
+    return run(maxCycles, hook, access);
+  }
+
+  // same, access.fetch(addr) is called for every opcode and operand byte, access.read(addr)
+  // and access.write(addr) for every data byte (stack included) before it is accessed
+  template <class Hook, class Access>
+  Stop run(uint64_t maxCycles, Hook & hook, Access & access) {
+    AccessBus<Access> bus { *this, access };
+    Core<AccessBus<Access>> core(cpu, bus);
+    while (true) {
+      if (cpu.pc == config.stopAddr) {
+        return Stop::Address;
+      }
+      if (pausePending(cpu.pc)) {
+        return Stop::Pause;
+      }
+      if (cpu.cycles >= maxCycles) {
+        return Stop::CycleLimit;
+      }
+      if (irqPending()) {
+        uint16_t pc = cpu.pc;
+        core.interrupt(7);
+        hook.interrupt(pc, cpu);
+      } else if (cpu.halted && !irqPossible()) {
+        return Stop::Halt;
+      }
+      uint16_t pc = cpu.pc;
+      uint16_t sp = cpu.sp;
+      uint8_t opcode = mem[pc];
+      uint64_t start = cpu.cycles;
+      core.step();
+      cpu.cycles += bus.fetchWait;
+      bus.fetchWait = 0;
+      hook.step(pc, sp, opcode, cpu.cycles - start, cpu);
+    }
+  }
+
+  // true when transmitter interrupt should be taken now
+  bool irqPending() const {
+    return irqPossible() && !cpu.eiDelay && cpu.cycles >= txReadyAt;
+  }
+
+  // true when transmitter interrupt can come, so HLT waits for it
+  bool irqPossible() const {
+    return config.txIrq && txUsed && cpu.inte;
+  }
+
+private:
+  // wait states of data accesses are added to cycles right away, so tick counter read sees ones before it
+  // in the same instruction, fetch wait states are added with instruction cycles, as block engine does
+  template <class Access>
+  struct AccessBus {
+    Machine & machine;
+    Access & access;
+    unsigned fetchWait = 0;
+
+    uint8_t fetch(uint16_t addr) {
+      access.fetch(addr);
+      fetchWait += machine.waitStates(addr);
+      return machine.read(addr);
+    }
+
+    uint8_t read(uint16_t addr) {
+      access.read(addr);
+      machine.cpu.cycles += machine.waitStates(addr);
+      return machine.read(addr);
+    }
+
+    void write(uint16_t addr, uint8_t v) {
+      access.write(addr);
+      machine.cpu.cycles += machine.waitStates(addr);
+      machine.write(addr, v);
+    }
+
+    uint8_t in(uint8_t port) {
+      return machine.in(port);
+    }
+
+    void out(uint8_t port, uint8_t v) {
+      machine.out(port, v);
+    }
+  };
+
+  bool txUsed = false;
+  uint64_t txReadyAt = 0;
+
+  friend void saveSnapshot(const Machine & machine, const std::string & path, const std::string & label);
+  friend std::string loadSnapshot(Machine & machine, const std::string & path);
+};
+
+}
+
+#endif
@@ -0,0 +1,60 @@
+#include "mapfile.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace sbc {
+
+static std::string trim(const std::string & s) {
+  size_t start = s.find_first_not_of(" \t\r");
+  if (start == std::string::npos) {
+    return "";
+  }
+  size_t end = s.find_last_not_of(" \t\r");
+  return s.substr(start, end - start + 1);
+}
+
+void MapFile::load(const std::string & path) {
+  std::ifstream in(path);
+  if (!in) {
+    throw std::runtime_error("can't open map file " + path);
+  }
+  entries.clear();
+  std::string line;
+  while (std::getline(in, line)) {
+    size_t eq = line.find('=');
+    size_t dollar = line.find('$', eq);
+    size_t semicolon = line.find(';', dollar);
+    if (eq == std::string::npos || dollar == std::string::npos || semicolon == std::string::npos) {
+      continue;
+    }
+    Symbol symbol;
+    symbol.name = trim(line.substr(0, eq));
+    symbol.value = std::stoul(line.substr(dollar + 1, semicolon - dollar - 1), nullptr, 16);
+
+    std::vector<std::string> fields;
+    std::stringstream attrs(line.substr(semicolon + 1));
+    std::string field;
+    while (std::getline(attrs, field, ',')) {
+      fields.push_back(trim(field));
+    }
+    fields.resize(6);
+    symbol.isAddr = fields[0] == "addr";
+    symbol.isPublic = fields[1] == "public";
+    symbol.module = fields[3];
+    symbol.section = fields[4];
+    entries.push_back(symbol);
+  }
+}
+
+const Symbol * MapFile::find(const std::string & name) const {
+  for (const Symbol & symbol : entries) {
+    if (symbol.name == name) {
+      return &symbol;
+    }
+  }
+  return nullptr;
+}
+
+}
@@ -0,0 +1,37 @@
+#ifndef __SBC_MAPFILE_H__
+#define __SBC_MAPFILE_H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sbc {
+
+// one line of z88dk .map file: "name = $ADDR ; addr, public, , module, section, source"
+struct Symbol {
+  std::string name;
+  uint16_t value = 0;
+  // "addr" symbols are labels, "const" ones are defc values
+  bool isAddr = false;
+  bool isPublic = false;
+  std::string module;
+  std::string section;
+};
+
+class MapFile {
+public:
+  // throws std::runtime_error if file can't be read
+  void load(const std::string & path);
+
+  // returns nullptr if there is no such symbol
+  const Symbol * find(const std::string & name) const;
+
+  const std::vector<Symbol> & symbols() const { return entries; }
+
+private:
+  std::vector<Symbol> entries;
+};
+
+}
+
+#endif
@@ -0,0 +1,185 @@
+#include "memtrace.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sbc {
+
+MemTrace::MemTrace(const Machine & machine, const std::vector<Region> & regions)
+  : machine(machine), regions(regions), fetches(0x10000), reads(0x10000), writes(0x10000) { }
+
+// programs assign small slots differently (pi_chudnovsky keeps coef in the first one), so they are named
+// by address, e.g. small_F800
+std::vector<MemTrace::Region> MemTrace::memoryMap() {
+  std::vector<Region> map;
+  map.push_back({ "rom", MEM_CODE_START, MEM_CODE_END - 1 });
+  map.push_back({ "data", MEM_DATA_START, MEM_DATA_END - 1 });
+  for (uint32_t start = MEM_SMALL_START; start < MEM_SMALL_END; start += MEM_SMALL_SIZE) {
+    char name[16] = "ticks";
+    if (start != MEM_TICKS) {
+      std::snprintf(name, sizeof(name), "small_%04X", start);
+    }
+    map.push_back({ name, (uint16_t)start, (uint16_t)(start + MEM_SMALL_SIZE - 1) });
+  }
+  map.push_back({ "stack", MEM_STACK_LIMIT, 0xFFFF });
+  return map;
+}
+
+std::vector<MemTrace::Region> MemTrace::slots(uint16_t size, unsigned count) {
+  std::vector<Region> slots;
+  for (unsigned i = 0; i < count; i++) {
+    uint32_t start = MEM_DATA_START + i * size;
+    if (size == 0 || start + size > MEM_DATA_END) {
+      break;
+    }
+    slots.push_back({ "slot" + std::to_string(i), (uint16_t)start, (uint16_t)(start + size - 1) });
+  }
+  return slots;
+}
+
+std::vector<MemTrace::Region> MemTrace::dataSymbols(const MapFile & map) {
+  std::vector<const Symbol *> symbols;
+  std::vector<uint32_t> bounds;
+  for (const Symbol & symbol : map.symbols()) {
+    if (!symbol.isAddr) {
+      continue;
+    }
+    bounds.push_back(symbol.value);
+    if (symbol.section.compare(0, 5, "data_") == 0 || symbol.section.compare(0, 4, "bss_") == 0) {
+      symbols.push_back(&symbol);
+    }
+  }
+  std::sort(bounds.begin(), bounds.end());
+  bounds.push_back(0x10000);
+
+  std::vector<Region> regions;
+  for (const Symbol * symbol : symbols) {
+    uint32_t end = *std::upper_bound(bounds.begin(), bounds.end(), (uint32_t)symbol->value);
+    // last variable of section ends at section tail
+    const Symbol * tail = map.find("__" + symbol->section + "_tail");
+    if (tail != nullptr && tail->value > symbol->value && tail->value < end) {
+      end = tail->value;
+    }
+    regions.push_back({ symbol->name, symbol->value, (uint16_t)(end - 1) });
+  }
+  std::sort(regions.begin(), regions.end(), [](const Region & a, const Region & b) {
+    return a.start < b.start;
+  });
+  return regions;
+}
+
+void MemTrace::endPhase(uint64_t now) {
+  Phase phase;
+  phase.start = phaseStart;
+  phase.end = now;
+  for (uint32_t addr = 0; addr < 0x10000; addr++) {
+    Counts & page = phase.pages[addr >> 8];
+    page.fetches += fetches[addr];
+    page.reads += reads[addr];
+    page.writes += writes[addr];
+  }
+  for (const Region & region : regions) {
+    RegionStats stats;
+    for (uint32_t addr = region.start; addr <= region.last; addr++) {
+      stats.counts.fetches += fetches[addr];
+      stats.counts.reads += reads[addr];
+      stats.counts.writes += writes[addr];
+      if (reads[addr] != 0 || writes[addr] != 0) {
+        if (stats.touched++ == 0) {
+          stats.lowest = addr - region.start;
+        }
+        stats.highest = addr - region.start;
+      }
+    }
+    phase.regions.push_back(stats);
+  }
+  phases.push_back(std::move(phase));
+
+  std::fill(fetches.begin(), fetches.end(), 0);
+  std::fill(reads.begin(), reads.end(), 0);
+  std::fill(writes.begin(), writes.end(), 0);
+  phaseStart = now;
+}
+
+void MemTrace::finish(const Cpu & cpu) {
+  endPhase(cpu.cycles);
+}
+
+// ' ' is no access, '@' is the busiest page, levels between them are logarithmic
+static char shade(uint64_t count, uint64_t max) {
+  static const char kLevels[] = " .:-=+*#%@";
+  if (count == 0) {
+    return kLevels[0];
+  }
+  if (max <= 1) {
+    return kLevels[9];
+  }
+  int level = 1 + (int)(8.0 * std::log((double)count) / std::log((double)max) + 0.5);
+  return kLevels[std::min(level, 9)];
+}
+
+static std::string phaseName(size_t i, size_t count) {
+  std::string from = i == 0 ? "start" : "marker " + std::to_string(i);
+  std::string to = i + 1 == count ? "end" : "marker " + std::to_string(i + 1);
+  return from + " -> " + to;
+}
+
+void MemTrace::print(FILE * out) const {
+  for (size_t i = 0; i < phases.size(); i++) {
+    const Phase & phase = phases[i];
+    std::fprintf(out, "%sphase %zu: %s, %llu cycles\n", i == 0 ? "" : "\n", i, phaseName(i, phases.size()).c_str(),
+      (unsigned long long)(phase.end - phase.start));
+
+    uint64_t maxData = 0, maxCode = 0;
+    for (const Counts & page : phase.pages) {
+      maxData = std::max(maxData, page.reads + page.writes);
+      maxCode = std::max(maxCode, page.fetches);
+    }
+    std::fprintf(out, "accesses per page, row is high nibble of page, \" .:-=+*#%%@\" up to busiest page\n");
+    std::fprintf(out, "     %-16s  %-16s\n", "data", "code");
+    std::fprintf(out, "     0123456789ABCDEF  0123456789ABCDEF\n");
+    for (unsigned row = 0; row < 16; row++) {
+      char data[17] = { }, code[17] = { };
+      for (unsigned col = 0; col < 16; col++) {
+        const Counts & page = phase.pages[row * 16 + col];
+        data[col] = shade(page.reads + page.writes, maxData);
+        code[col] = shade(page.fetches, maxCode);
+      }
+      std::fprintf(out, "  %Xx %s  %s\n", row, data, code);
+    }
+
+    std::fprintf(out, "%-24s %-11s %14s %14s %14s %7s  %s\n",
+      "region", "range", "fetches", "reads", "writes", "touched", "used offsets");
+    for (size_t r = 0; r < regions.size(); r++) {
+      const Region & region = regions[r];
+      const RegionStats & stats = phase.regions[r];
+      if (stats.counts.fetches == 0 && stats.counts.reads == 0 && stats.counts.writes == 0) {
+        continue;
+      }
+      char range[16];
+      std::snprintf(range, sizeof(range), "%04X..%04X", region.start, region.last);
+      char used[16] = "-";
+      if (stats.touched != 0) {
+        std::snprintf(used, sizeof(used), "%04X..%04X", stats.lowest, stats.highest);
+      }
+      std::fprintf(out, "%-24s %-11s %14llu %14llu %14llu %7u  %s\n", region.name.c_str(), range,
+        (unsigned long long)stats.counts.fetches, (unsigned long long)stats.counts.reads,
+        (unsigned long long)stats.counts.writes, stats.touched, used);
+    }
+  }
+}
+
+void MemTrace::printCsv(FILE * out) const {
+  std::fprintf(out, "phase,page,fetches,reads,writes\n");
+  for (size_t i = 0; i < phases.size(); i++) {
+    for (unsigned p = 0; p < 256; p++) {
+      const Counts & page = phases[i].pages[p];
+      if (page.fetches != 0 || page.reads != 0 || page.writes != 0) {
+        std::fprintf(out, "%zu,%02X,%llu,%llu,%llu\n", i, p, (unsigned long long)page.fetches,
+          (unsigned long long)page.reads, (unsigned long long)page.writes);
+      }
+    }
+  }
+}
+
+}
@@ -0,0 +1,103 @@
+#ifndef __SBC_MEMTRACE_H__
+#define __SBC_MEMTRACE_H__
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "machine.h"
+#include "mapfile.h"
+
+namespace sbc {
+
+// counts memory accesses per byte between 0x05 markers, used as Machine::run() hook and access hook,
+// each phase (start -> marker 1, marker 1 -> 2, ..., last marker -> end) is summarized per 256-byte page
+// and per named region
+class MemTrace {
+public:
+  struct Region {
+    std::string name;
+    uint16_t start;
+    // last byte, inclusive
+    uint16_t last;
+  };
+
+  struct Counts {
+    uint64_t fetches = 0;
+    uint64_t reads = 0;
+    uint64_t writes = 0;
+  };
+
+  struct RegionStats {
+    Counts counts;
+    // distinct bytes read or written (working set), fetches don't count
+    uint32_t touched = 0;
+    // lowest and highest offsets read or written, -1 if none
+    int lowest = -1;
+    int highest = -1;
+  };
+
+  struct Phase {
+    uint64_t start = 0;
+    uint64_t end = 0;
+    Counts pages[256];
+    std::vector<RegionStats> regions;
+  };
+
+  MemTrace(const Machine & machine, const std::vector<Region> & regions);
+
+  // regions of shared/memmap.h: rom, data, small number slots named by address (small_F800...) with
+  // tick counter slot named ticks, stack
+  static std::vector<Region> memoryMap();
+  // count slots of size bytes from start of data region, named slot0, slot1... like SLOT(i) of pi programs
+  static std::vector<Region> slots(uint16_t size, unsigned count);
+  // static variables of data_ and bss_ sections of .map file, each one ends at the next symbol
+  static std::vector<Region> dataSymbols(const MapFile & map);
+
+  void fetch(uint16_t addr) {
+    fetches[addr]++;
+  }
+
+  void read(uint16_t addr) {
+    reads[addr]++;
+  }
+
+  void write(uint16_t addr) {
+    writes[addr]++;
+  }
+
+  void step(uint16_t, uint16_t, uint8_t, unsigned, const Cpu &) {
+    if (machine.markers.size() > markersSeen) {
+      markersSeen = machine.markers.size();
+      endPhase(machine.markers.back());
+    }
+  }
+
+  void interrupt(uint16_t, const Cpu &) { }
+
+  // closes last phase, should be called when run is over
+  void finish(const Cpu & cpu);
+
+  const std::vector<Phase> & result() const { return phases; }
+
+  // heatmaps of data and code accesses per page and table of regions with accesses for each phase
+  void print(FILE * out) const;
+
+  // "phase,page,fetches,reads,writes" line for each page with accesses
+  void printCsv(FILE * out) const;
+
+private:
+  const Machine & machine;
+  std::vector<Region> regions;
+  std::vector<uint64_t> fetches, reads, writes;
+  std::vector<Phase> phases;
+  size_t markersSeen = 0;
+  uint64_t phaseStart = 0;
+
+  void endPhase(uint64_t now);
+};
+
+}
+
+#endif
@@ -0,0 +1,166 @@
+#include "opmix.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+
+namespace sbc {
+
+const char * opClassName(OpClass c) {
+  switch (c) {
+    case OpClass::PushPop: return "PUSH/POP";
+    case OpClass::CallReturn: return "CALL/RET/RST";
+    case OpClass::Jump: return "JMP/PCHL";
+    case OpClass::Memory: return "memory operand";
+    case OpClass::Dad: return "DAD";
+    case OpClass::IncDec16: return "INX/DCX";
+    case OpClass::Alu: return "ALU r/imm";
+    case OpClass::IncDec8: return "INR/DCR r";
+    case OpClass::Move: return "MOV r,r";
+    case OpClass::Immediate: return "MVI r/LXI";
+    case OpClass::Exchange: return "XCHG/XTHL/SPHL";
+    case OpClass::Misc: return "other";
+    default: return "interrupt";
+  }
+}
+
+OpClass opClass(uint8_t opcode) {
+  bool srcM = (opcode & 7) == 6;
+  bool dstM = ((opcode >> 3) & 7) == 6;
+  if ((opcode & 0xCB) == 0xC1) {
+    return OpClass::PushPop;
+  }
+  if ((opcode & 0xC7) == 0xC4 || (opcode & 0xCF) == 0xCD || (opcode & 0xC7) == 0xC0
+    || (opcode & 0xEF) == 0xC9 || (opcode & 0xC7) == 0xC7) {
+    return OpClass::CallReturn;
+  }
+  if ((opcode & 0xC7) == 0xC2 || (opcode & 0xF7) == 0xC3 || opcode == 0xE9) {
+    return OpClass::Jump;
+  }
+  if (opcode >= 0x40 && opcode < 0x80) {
+    if (opcode == 0x76) {
+      return OpClass::Misc;
+    }
+    return srcM || dstM ? OpClass::Memory : OpClass::Move;
+  }
+  if (opcode >= 0x80 && opcode < 0xC0) {
+    return srcM ? OpClass::Memory : OpClass::Alu;
+  }
+  switch (opcode) {
+    case 0x02: case 0x12: case 0x0A: case 0x1A:
+    case 0x22: case 0x2A: case 0x32: case 0x3A:
+    case 0x34: case 0x35: case 0x36:
+      return OpClass::Memory;
+    case 0xEB: case 0xE3: case 0xF9:
+      return OpClass::Exchange;
+  }
+  if (opcode < 0x40) {
+    switch (opcode & 0x0F) {
+      case 0x01: return OpClass::Immediate;
+      case 0x03: case 0x0B: return OpClass::IncDec16;
+      case 0x09: return OpClass::Dad;
+    }
+    switch (opcode & 0x07) {
+      case 0x04: case 0x05: return OpClass::IncDec8;
+      case 0x06: return OpClass::Immediate;
+    }
+    return OpClass::Misc;
+  }
+  if ((opcode & 0xC7) == 0xC6) {
+    return OpClass::Alu;
+  }
+  return OpClass::Misc;
+}
+
+std::vector<uint64_t> OpcodeMix::classCycles() const {
+  std::vector<uint64_t> result((size_t)OpClass::Count);
+  for (unsigned op = 0; op < 256; op++) {
+    result[(size_t)opClass(op)] += cycles[op];
+  }
+  result[(size_t)OpClass::Interrupt] += interrupts * kInterruptCycles;
+  return result;
+}
+
+// mnemonic without operands, "ADC M" -> "ADC"
+static std::string baseMnemonic(uint8_t opcode) {
+  std::string m = kMnemonics[opcode];
+  return m.substr(0, m.find(' '));
+}
+
+void OpcodeMix::print(FILE * out, size_t top) const {
+  uint64_t totalCycles = interrupts * kInterruptCycles, totalCount = 0;
+  for (unsigned op = 0; op < 256; op++) {
+    totalCycles += cycles[op];
+    totalCount += counts[op];
+  }
+  double cyclePct = totalCycles == 0 ? 0.0 : 100.0 / totalCycles;
+  double countPct = totalCount == 0 ? 0.0 : 100.0 / totalCount;
+
+  std::vector<uint64_t> byClass = classCycles();
+  std::vector<uint64_t> classCounts((size_t)OpClass::Count);
+  for (unsigned op = 0; op < 256; op++) {
+    classCounts[(size_t)opClass(op)] += counts[op];
+  }
+  classCounts[(size_t)OpClass::Interrupt] = interrupts;
+  std::fprintf(out, "%llu instructions, %llu cycles\n\n", (unsigned long long)totalCount, (unsigned long long)totalCycles);
+  std::fprintf(out, "%-16s %7s %14s %7s %14s\n", "class", "cycles%", "cycles", "count%", "count");
+  for (size_t c = 0; c < byClass.size(); c++) {
+    std::fprintf(out, "%-16s %6.2f%% %14llu %6.2f%% %14llu\n", opClassName((OpClass)c),
+      byClass[c] * cyclePct, (unsigned long long)byClass[c], classCounts[c] * countPct, (unsigned long long)classCounts[c]);
+  }
+
+  std::vector<unsigned> ops;
+  for (unsigned op = 0; op < 256; op++) {
+    if (counts[op] != 0) {
+      ops.push_back(op);
+    }
+  }
+  std::stable_sort(ops.begin(), ops.end(), [this](unsigned a, unsigned b) {
+    return cycles[a] > cycles[b];
+  });
+  std::fprintf(out, "\n%-12s %7s %14s %7s %14s\n", "opcode", "cycles%", "cycles", "count%", "count");
+  for (size_t i = 0; i < std::min(top, ops.size()); i++) {
+    unsigned op = ops[i];
+    std::fprintf(out, "%-12s %6.2f%% %14llu %6.2f%% %14llu\n", kMnemonics[op],
+      cycles[op] * cyclePct, (unsigned long long)cycles[op], counts[op] * countPct, (unsigned long long)counts[op]);
+  }
+
+  std::map<std::string, std::pair<uint64_t, uint64_t>> mnemonics;
+  for (unsigned op = 0; op < 256; op++) {
+    if (counts[op] != 0) {
+      auto & m = mnemonics[baseMnemonic(op)];
+      m.first += cycles[op];
+      m.second += counts[op];
+    }
+  }
+  std::vector<std::pair<std::string, std::pair<uint64_t, uint64_t>>> rows(mnemonics.begin(), mnemonics.end());
+  std::stable_sort(rows.begin(), rows.end(), [](const auto & a, const auto & b) {
+    return a.second.first > b.second.first;
+  });
+  std::fprintf(out, "\n%-12s %7s %14s %7s %14s\n", "mnemonic", "cycles%", "cycles", "count%", "count");
+  for (size_t i = 0; i < std::min(top, rows.size()); i++) {
+    std::fprintf(out, "%-12s %6.2f%% %14llu %6.2f%% %14llu\n", rows[i].first.c_str(),
+      rows[i].second.first * cyclePct, (unsigned long long)rows[i].second.first,
+      rows[i].second.second * countPct, (unsigned long long)rows[i].second.second);
+  }
+
+  std::vector<unsigned> pairIds;
+  for (unsigned i = 0; i < 0x10000; i++) {
+    if (pairs[i] != 0) {
+      pairIds.push_back(i);
+    }
+  }
+  std::stable_sort(pairIds.begin(), pairIds.end(), [this](unsigned a, unsigned b) {
+    return pairs[a] > pairs[b];
+  });
+  uint64_t totalPairs = totalCount > 0 ? totalCount - 1 : 0;
+  std::fprintf(out, "\n%-26s %7s %14s\n", "pair", "count%", "count");
+  for (size_t i = 0; i < std::min(top, pairIds.size()); i++) {
+    unsigned id = pairIds[i];
+    std::string pair = std::string(kMnemonics[id >> 8]) + " ; " + kMnemonics[id & 0xFF];
+    std::fprintf(out, "%-26s %6.2f%% %14llu\n", pair.c_str(),
+      totalPairs == 0 ? 0.0 : 100.0 * pairs[id] / totalPairs, (unsigned long long)pairs[id]);
+  }
+}
+
+}
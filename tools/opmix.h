@@ -0,0 +1,74 @@
+#ifndef __SBC_OPMIX_H__
+#define __SBC_OPMIX_H__
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "i8080.h"
+
+namespace sbc {
+
+// groups of opcodes opcode mix is summarized by
+enum class OpClass {
+  PushPop,
+  CallReturn,
+  Jump,
+  Memory,
+  Dad,
+  IncDec16,
+  Alu,
+  IncDec8,
+  Move,
+  Immediate,
+  Exchange,
+  Misc,
+  Interrupt,
+  Count,
+};
+
+const char * opClassName(OpClass c);
+
+// PUSH/POP, CALL/RET/RST, JMP/PCHL, memory operand (M, direct address, LDAX/STAX), DAD, INX/DCX,
+// ALU with register or immediate, INR/DCR of register, MOV r,r, MVI r/LXI, XCHG/XTHL/SPHL, the rest
+OpClass opClass(uint8_t opcode);
+
+// dynamic opcode counts, cycles and pairs of adjacent opcodes, used as Machine::run() hook
+class OpcodeMix {
+public:
+  uint64_t counts[256] = { };
+  uint64_t cycles[256] = { };
+  // pairs[first * 256 + second]
+  std::vector<uint64_t> pairs;
+  uint64_t interrupts = 0;
+
+  OpcodeMix() : pairs(0x10000) { }
+
+  void step(uint16_t, uint16_t, uint8_t opcode, unsigned instructionCycles, const Cpu &) {
+    counts[opcode]++;
+    cycles[opcode] += instructionCycles;
+    if (prev >= 0) {
+      pairs[prev * 256 + opcode]++;
+    }
+    prev = opcode;
+  }
+
+  void interrupt(uint16_t, const Cpu &) {
+    interrupts++;
+  }
+
+  // cycles of each OpClass, interrupt acknowledge included
+  std::vector<uint64_t> classCycles() const;
+
+  // cycle share per class, top opcodes by cycles, mnemonics without operands (all ADC, all MOV...)
+  // and top pairs by count
+  void print(FILE * out, size_t top) const;
+
+private:
+  // previous opcode, -1 before the first one
+  int prev = -1;
+};
+
+}
+
+#endif
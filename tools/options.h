@@ -0,0 +1,63 @@
+#ifndef __SBC_OPTIONS_H__
+#define __SBC_OPTIONS_H__
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace sbc {
+
+// minimal command line walker: "--name value" options and positional arguments
+class Options {
+public:
+  Options(int argc, char ** argv) : argc(argc), argv(argv) { }
+
+  bool next() {
+    return ++index < argc;
+  }
+
+  const char * current() const {
+    return argv[index];
+  }
+
+  bool is(const char * name) const {
+    return std::string(argv[index]) == name;
+  }
+
+  bool isPositional() const {
+    return argv[index][0] != '-';
+  }
+
+  // value that follows current option
+  std::string value() {
+    if (index + 1 >= argc) {
+      throw std::runtime_error(std::string("missing value of ") + argv[index]);
+    }
+    return argv[++index];
+  }
+
+  // decimal, 0x-prefixed hex or floating point number like 1e9
+  uint64_t number() {
+    std::string s = value();
+    size_t used = 0;
+    uint64_t v;
+    if (s.find_first_of(".eE") != std::string::npos && s.compare(0, 2, "0x") != 0) {
+      v = (uint64_t)std::stod(s, &used);
+    } else {
+      v = std::stoull(s, &used, 0);
+    }
+    if (used != s.size()) {
+      throw std::runtime_error("bad number " + s);
+    }
+    return v;
+  }
+
+private:
+  int argc;
+  char ** argv;
+  int index = 0;
+};
+
+}
+
+#endif
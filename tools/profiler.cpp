@@ -0,0 +1,115 @@
+#include "profiler.h"
+
+#include <algorithm>
+
+namespace sbc {
+
+static bool isCode(const Symbol & symbol) {
+  return symbol.isAddr && (symbol.section.empty() || symbol.section.compare(0, 4, "code") == 0);
+}
+
+Profiler::Profiler(const MapFile & map, bool allLabels) : owner(0x10000, 0) {
+  std::vector<const Symbol *> labels;
+  for (const Symbol & symbol : map.symbols()) {
+    if (isCode(symbol)) {
+      labels.push_back(&symbol);
+    }
+  }
+  // public label goes first among labels with the same address, so it names the function
+  std::sort(labels.begin(), labels.end(), [](const Symbol * a, const Symbol * b) {
+    if (a->value != b->value) {
+      return a->value < b->value;
+    }
+    if (a->isPublic != b->isPublic) {
+      return a->isPublic;
+    }
+    return a->name < b->name;
+  });
+
+  Function unknown;
+  unknown.name = "(no symbol)";
+  functions.push_back(unknown);
+
+  const Symbol * current = nullptr;
+  for (const Symbol * label : labels) {
+    if (current != nullptr && label->value == current->value) {
+      continue;
+    }
+    bool starts = allLabels || current == nullptr || label->isPublic || label->module != current->module
+      || (label->section == "code_compiler" && label->name[0] == '_');
+    if (!starts) {
+      continue;
+    }
+    current = label;
+    Function function;
+    function.name = label->name;
+    function.addr = label->value;
+    functions.push_back(function);
+  }
+
+  for (uint32_t i = 1; i < functions.size(); i++) {
+    uint32_t end = i + 1 < functions.size() ? functions[i + 1].addr : 0x10000;
+    for (uint32_t addr = functions[i].addr; addr < end; addr++) {
+      owner[addr] = i;
+    }
+  }
+}
+
+void Profiler::enter(const Cpu & cpu, uint16_t ret) {
+  uint32_t function = owner[cpu.pc];
+  Function & f = functions[function];
+  f.calls++;
+  f.active++;
+  frames.push_back({ function, ret, cpu.cycles });
+}
+
+void Profiler::pop(uint64_t now) {
+  Frame frame = frames.back();
+  frames.pop_back();
+  Function & f = functions[frame.function];
+  if (--f.active == 0) {
+    f.inclusive += now - frame.start;
+  }
+}
+
+void Profiler::finish(const Cpu & cpu) {
+  while (!frames.empty()) {
+    pop(cpu.cycles);
+  }
+}
+
+static void printTable(FILE * out, const std::vector<const Profiler::Function *> & rows, uint64_t total) {
+  std::fprintf(out, "%7s %14s %7s %14s %10s  %s\n", "self%", "self", "incl%", "inclusive", "calls", "function");
+  for (const Profiler::Function * f : rows) {
+    std::fprintf(out, "%6.2f%% %14llu %6.2f%% %14llu %10llu  %s\n",
+      100.0 * f->self / total, (unsigned long long)f->self,
+      100.0 * f->inclusive / total, (unsigned long long)f->inclusive,
+      (unsigned long long)f->calls, f->name.c_str());
+  }
+}
+
+void Profiler::print(FILE * out, uint64_t total, size_t top) const {
+  if (total == 0) {
+    total = 1;
+  }
+  std::vector<const Function *> rows;
+  for (const Function & f : functions) {
+    if (f.self != 0 || f.inclusive != 0) {
+      rows.push_back(&f);
+    }
+  }
+
+  std::stable_sort(rows.begin(), rows.end(), [](const Function * a, const Function * b) {
+    return a->self > b->self;
+  });
+  std::fprintf(out, "flat profile, %llu cycles\n", (unsigned long long)total);
+  printTable(out, std::vector<const Function *>(rows.begin(), rows.begin() + std::min(top, rows.size())), total);
+
+  std::stable_sort(rows.begin(), rows.end(), [](const Function * a, const Function * b) {
+    return a->inclusive > b->inclusive;
+  });
+  std::fprintf(out, "\ninclusive profile\n");
+  printTable(out, std::vector<const Function *>(rows.begin(), rows.begin() + std::min(top, rows.size())), total);
+}
+
+}
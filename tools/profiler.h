@@ -0,0 +1,101 @@
+#ifndef __SBC_PROFILER_H__
+#define __SBC_PROFILER_H__
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "i8080.h"
+#include "mapfile.h"
+
+namespace sbc {
+
+// attributes cycles to functions from .map file, used as Machine::run() hook
+//
+// flat (self) cycles go to function that owns PC, inclusive ones are counted from CALL (or interrupt)
+// until RET or PCHL lands on its return address, runtime helpers like l_glong2sp return with PCHL
+// leaving values on stack; frames skipped by such return are closed too, recursive calls are counted once,
+// call through l_jphl is counted as inclusive time of l_jphl
+class Profiler {
+public:
+  struct Function {
+    std::string name;
+    uint16_t addr = 0;
+    uint64_t self = 0;
+    uint64_t inclusive = 0;
+    uint64_t calls = 0;
+    // number of frames of this function on the call stack
+    unsigned active = 0;
+  };
+
+  // each public code label and each C function starts a function, local labels of asm modules
+  // (loops of l_long_div_u etc.) and "i_nn" labels of compiled code belong to the function before them,
+  // with allLabels every code label is a function
+  Profiler(const MapFile & map, bool allLabels = false);
+
+  void step(uint16_t pc, uint16_t sp, uint8_t opcode, unsigned cycles, const Cpu & cpu) {
+    functions[owner[pc]].self += cycles;
+    if (isCall(opcode)) {
+      if (cpu.sp == (uint16_t)(sp - 2)) {
+        enter(cpu, pc + kLengths[opcode]);
+      }
+    } else if (opcode == 0xE9 || opcode == 0xC9 || opcode == 0xD9
+      || ((opcode & 0xC7) == 0xC0 && cpu.sp == (uint16_t)(sp + 2))) {
+      leave(cpu);
+    }
+  }
+
+  void interrupt(uint16_t pc, const Cpu & cpu) {
+    functions[owner[cpu.pc]].self += kInterruptCycles;
+    enter(cpu, pc);
+  }
+
+  // closes frames left on the call stack, should be called when run is over
+  void finish(const Cpu & cpu);
+
+  const std::vector<Function> & result() const { return functions; }
+
+  // prints functions sorted by self and by inclusive cycles, top functions of each
+  void print(FILE * out, uint64_t total, size_t top) const;
+
+private:
+  struct Frame {
+    uint32_t function;
+    uint16_t ret;
+    uint64_t start;
+  };
+
+  std::vector<Function> functions;
+  std::vector<uint32_t> owner;
+  std::vector<Frame> frames;
+
+  static bool isCall(uint8_t opcode) {
+    // CALL, Ccc, RST and undocumented CALL copies
+    return (opcode & 0xC7) == 0xC4 || (opcode & 0xC7) == 0xC7 || (opcode & 0xCF) == 0xCD;
+  }
+
+  void enter(const Cpu & cpu, uint16_t ret);
+
+  // closes the innermost frame returning to PC and frames above it, if there is none, but PC is back
+  // in the caller of the innermost frame (l_case jumps to the case code), closes that frame
+  void leave(const Cpu & cpu) {
+    for (size_t i = frames.size(); i-- > 0; ) {
+      if (frames[i].ret == cpu.pc) {
+        while (frames.size() > i) {
+          pop(cpu.cycles);
+        }
+        return;
+      }
+    }
+    if (!frames.empty() && owner[cpu.pc] == owner[frames.back().ret] && owner[cpu.pc] != frames.back().function) {
+      pop(cpu.cycles);
+    }
+  }
+
+  void pop(uint64_t now);
+};
+
+}
+
+#endif
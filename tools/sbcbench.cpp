@@ -0,0 +1,203 @@
+// runs every program image of the suite, stores cycles and printed ticks in history file
+// and compares them with earlier commit
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+#include "bench.h"
+#include "options.h"
+
+using namespace sbc;
+
+static void usage() {
+  std::fprintf(stderr,
+    "usage: sbcbench [options] [image names]\n"
+    "  runs images from programs/*/ (or only named ones), appends results to history and compares them\n"
+    "  with baseline, exit code is 1 if any value grew above threshold or any run didn't finish\n"
+    "  --programs DIR    programs folder (default programs)\n"
+    "  --history FILE    CSV history (default bench_history.csv)\n"
+    "  --threshold PCT   allowed growth in percents (default 1)\n"
+    "  --baseline ID     commit to compare with (default: last other commit in history)\n"
+    "  --commit ID       commit results are stored under (default: git rev-parse --short HEAD)\n"
+    "  --build           runs \"zcc\" lines of each build.bat first, needs zcc in PATH and ZCCCFG set\n"
+    "  --max-cycles N    run of each image stops after N cycles (default 1e11)\n"
+    "  --dry-run         history file isn't updated\n");
+  std::exit(2);
+}
+
+// first line of command output, empty if it fails
+static std::string commandLine(const char * command) {
+  std::string line;
+  if (FILE * p = popen(command, "r")) {
+    char buf[256];
+    if (std::fgets(buf, sizeof(buf), p) != nullptr) {
+      line = buf;
+    }
+    if (pclose(p) != 0) {
+      line.clear();
+    }
+  }
+  while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
+    line.pop_back();
+  }
+  return line;
+}
+
+// short hash of HEAD, "-dirty" is appended if tracked files are modified
+static std::string currentCommit() {
+  std::string commit = commandLine("git rev-parse --short HEAD 2>/dev/null");
+  if (commit.empty()) {
+    return "unknown";
+  }
+  if (!commandLine("git status --porcelain --untracked-files=no 2>/dev/null").empty()) {
+    commit += "-dirty";
+  }
+  return commit;
+}
+
+static bool build(const std::string & programs, const std::set<std::string> & names) {
+  namespace fs = std::filesystem;
+  bool ok = true;
+  for (const fs::directory_entry & dir : fs::directory_iterator(programs)) {
+    fs::path buildBat = dir.path() / "build.bat";
+    if (!fs::exists(buildBat)) {
+      continue;
+    }
+    for (const std::string & command : buildCommands(buildBat.string())) {
+      if (!names.empty() && names.count(outputName(command)) == 0) {
+        continue;
+      }
+      std::fprintf(stderr, "build %s: %s\n", dir.path().filename().string().c_str(), command.c_str());
+      std::string shell = "cd \"" + dir.path().string() + "\" && " + command;
+      if (std::system(shell.c_str()) != 0) {
+        std::fprintf(stderr, "build failed\n");
+        ok = false;
+      }
+    }
+  }
+  return ok;
+}
+
+int main(int argc, char ** argv) {
+  Options options(argc, argv);
+  std::string programs = "programs";
+  std::string historyPath = "bench_history.csv";
+  std::string baseline, commit;
+  double threshold = 1.0;
+  bool doBuild = false, dryRun = false;
+  uint64_t maxCycles = 100000000000ULL;
+  std::set<std::string> names;
+  try {
+    while (options.next()) {
+      if (options.is("--programs")) {
+        programs = options.value();
+      } else if (options.is("--history")) {
+        historyPath = options.value();
+      } else if (options.is("--threshold")) {
+        threshold = std::stod(options.value());
+      } else if (options.is("--baseline")) {
+        baseline = options.value();
+      } else if (options.is("--commit")) {
+        commit = options.value();
+      } else if (options.is("--build")) {
+        doBuild = true;
+      } else if (options.is("--max-cycles")) {
+        maxCycles = options.number();
+      } else if (options.is("--dry-run")) {
+        dryRun = true;
+      } else if (options.isPositional()) {
+        names.insert(options.current());
+      } else {
+        usage();
+      }
+    }
+    if (commit.empty()) {
+      commit = currentCommit();
+    }
+
+    bool ok = true;
+    if (doBuild) {
+      ok = build(programs, names);
+    }
+
+    std::vector<Record> history = loadHistory(historyPath);
+    if (baseline.empty()) {
+      for (const Record & r : history) {
+        if (r.commit != commit) {
+          baseline = r.commit;
+        }
+      }
+    }
+    // (image, metric) -> value at baseline
+    std::map<std::pair<std::string, std::string>, uint64_t> base;
+    for (const Record & r : history) {
+      if (r.commit == baseline) {
+        base[{ r.image, r.metric }] = r.value;
+      }
+    }
+
+    std::vector<Record> current;
+    uint64_t now = std::time(nullptr);
+    for (const std::string & path : findImages(programs)) {
+      std::string image = std::filesystem::relative(path, programs).generic_string();
+      if (!names.empty() && names.count(std::filesystem::path(path).filename().string()) == 0) {
+        continue;
+      }
+      std::fprintf(stderr, "run %s\n", image.c_str());
+      RunResult result = runImage(path, maxCycles);
+      if (result.stop == Stop::CycleLimit) {
+        std::fprintf(stderr, "%s: stopped at cycle limit, values aren't stored\n", image.c_str());
+        ok = false;
+        continue;
+      }
+      for (const Metric & metric : result.metrics) {
+        current.push_back({ commit, now, image, metric.name, metric.value });
+      }
+    }
+
+    std::printf("commit %s, baseline %s, threshold %.2f%%\n", commit.c_str(),
+      baseline.empty() ? "(none)" : baseline.c_str(), threshold);
+    std::printf("%-36s %-28s %14s %14s %9s\n", "image", "metric", "baseline", "current", "change");
+    unsigned regressions = 0;
+    for (const Record & r : current) {
+      auto it = base.find({ r.image, r.metric });
+      if (it == base.end()) {
+        std::printf("%-36s %-28s %14s %14llu %9s\n", r.image.c_str(), r.metric.c_str(), "-",
+          (unsigned long long)r.value, "new");
+        continue;
+      }
+      double change = it->second == 0 ? (r.value == 0 ? 0.0 : 100.0) : 100.0 * ((double)r.value - it->second) / it->second;
+      bool regressed = change > threshold;
+      regressions += regressed;
+      std::printf("%-36s %-28s %14llu %14llu %+8.2f%%%s\n", r.image.c_str(), r.metric.c_str(),
+        (unsigned long long)it->second, (unsigned long long)r.value, change, regressed ? "  REGRESSION" : "");
+    }
+    std::printf("%u regression(s)\n", regressions);
+
+    if (!dryRun) {
+      // results of images run now replace ones stored earlier under the same commit
+      std::set<std::string> runImages;
+      for (const Record & r : current) {
+        runImages.insert(r.image);
+      }
+      std::vector<Record> kept;
+      for (const Record & r : history) {
+        if (r.commit != commit || runImages.count(r.image) == 0) {
+          kept.push_back(r);
+        }
+      }
+      kept.insert(kept.end(), current.begin(), current.end());
+      saveHistory(historyPath, kept);
+    }
+    return ok && regressions == 0 ? 0 : 1;
+  } catch (const std::exception & e) {
+    std::fprintf(stderr, "sbcbench: %s\n", e.what());
+    return 2;
+  }
+}
@@ -0,0 +1,135 @@
+// timing calibration: writes probe programs to be run on the board, then fits wait states, OUT latency
+// and tick offset of emulator timing model to outputs read from the board
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "options.h"
+#include "timing.h"
+
+using namespace sbc;
+
+static void usage() {
+  std::fprintf(stderr,
+    "usage: sbccal [options] [measured]\n"
+    "  without measured file prints output each probe gives with timing options below,\n"
+    "  measured file has \"probe byte byte...\" lines with output read from the board, e.g. \"clocks 0x1A\",\n"
+    "  timing model that reproduces them best is printed as sbcemu options\n"
+    "  --write DIR       writes probe images (raw, loaded at 0) to DIR\n"
+    "  --programs DIR    folder with clocks, read_ram and write_ram images (default: programs)\n"
+    "  --max-wait N      wait states tried for each region (default 3)\n"
+    "  --max-out-wait N  latencies of OUT to console port tried (default 15)\n"
+    "%s", kTimingUsage);
+  std::exit(2);
+}
+
+static std::string hexBytes(const std::string & output) {
+  std::string s;
+  for (unsigned char c : output) {
+    char buf[8];
+    std::snprintf(buf, sizeof(buf), "%s0x%02X", s.empty() ? "" : " ", c);
+    s += buf;
+  }
+  return s.empty() ? "-" : s;
+}
+
+// micro-programs of programs folder, clocks prints raw counter byte, read_ram and write_ram check
+// memory map (0xAA and 0xBB) without timing
+static void addPrograms(const std::string & dir, std::vector<Probe> & probes) {
+  struct Program {
+    const char * name;
+    const char * description;
+    bool absolute;
+  };
+  static const Program programs[] = {
+    { "clocks", "programs/clocks: tick counter low byte after 2 NOPs", true },
+    { "read_ram", "programs/read_ram: byte of ROM image", false },
+    { "write_ram", "programs/write_ram: byte written to 0x1006", false },
+  };
+  for (const Program & program : programs) {
+    std::ifstream in(dir + "/" + program.name + "/" + program.name, std::ios::binary);
+    if (in) {
+      std::vector<uint8_t> image((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+      probes.push_back({ program.name, program.description, image, program.absolute });
+    }
+  }
+}
+
+int main(int argc, char ** argv) {
+  Options options(argc, argv);
+  std::string writeDir, programsDir = "programs", measuredPath;
+  unsigned maxWait = 3, maxOutWait = 15;
+  Config model;
+  try {
+    while (options.next()) {
+      if (options.is("--write")) {
+        writeDir = options.value();
+      } else if (options.is("--programs")) {
+        programsDir = options.value();
+      } else if (options.is("--max-wait")) {
+        maxWait = options.number();
+      } else if (options.is("--max-out-wait")) {
+        maxOutWait = options.number();
+      } else if (options.isPositional() && measuredPath.empty()) {
+        measuredPath = options.current();
+      } else if (!parseTimingOption(options, model)) {
+        usage();
+      }
+    }
+
+    std::vector<Probe> probes;
+    addPrograms(programsDir, probes);
+    std::vector<Probe> generated = timingProbes();
+    probes.insert(probes.end(), generated.begin(), generated.end());
+
+    if (!writeDir.empty()) {
+      std::filesystem::create_directories(writeDir);
+      for (const Probe & probe : generated) {
+        std::ofstream out(writeDir + "/" + probe.name, std::ios::binary);
+        out.write((const char *)probe.image.data(), probe.image.size());
+        if (!out) {
+          throw std::runtime_error("can't write " + writeDir + "/" + probe.name);
+        }
+      }
+      std::fprintf(stderr, "%zu probes written to %s\n", generated.size(), writeDir.c_str());
+    }
+
+    if (measuredPath.empty()) {
+      std::printf("%-18s %-12s  %s\n", "probe", "output", "");
+      for (const Probe & probe : probes) {
+        std::printf("%-18s %-12s  %s\n", probe.name.c_str(), hexBytes(runProbe(probe.image, model)).c_str(),
+          probe.description.c_str());
+      }
+      return 0;
+    }
+
+    std::vector<Measurement> measured = loadMeasurements(measuredPath);
+    TimingFit fit = fitTiming(probes, measured, model, maxWait, maxOutWait);
+    std::printf("%-18s %-12s %-12s %-12s\n", "probe", "measured", "model", "fitted");
+    for (const Measurement & m : measured) {
+      for (const Probe & probe : probes) {
+        if (probe.name == m.probe) {
+          std::string fitted = runProbe(probe.image, fit.config);
+          std::printf("%-18s %-12s %-12s %-12s%s\n", m.probe.c_str(), hexBytes(m.output).c_str(),
+            hexBytes(runProbe(probe.image, model)).c_str(), hexBytes(fitted).c_str(), fitted == m.output ? "" : "  differs");
+        }
+      }
+    }
+    std::string fitted = timingOptions(fit.config);
+    std::printf("\nfitted timing: %s\n", fitted.empty() ? "datasheet cycles, no wait states" : fitted.c_str());
+    if (fit.mismatches != 0) {
+      std::printf("%u measured bytes aren't reproduced, try larger --max-wait or --max-out-wait\n", fit.mismatches);
+      return 1;
+    }
+    return 0;
+  } catch (const std::exception & e) {
+    std::fprintf(stderr, "sbccal: %s\n", e.what());
+    return 2;
+  }
+}
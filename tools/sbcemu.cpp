@@ -0,0 +1,186 @@
+// runs program image of i8080-sbc, prints its console output and cycles between 0x05 markers
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "blockengine.h"
+#include "layout.h"
+#include "machine.h"
+#include "mapfile.h"
+#include "options.h"
+#include "snapshot.h"
+#include "timing.h"
+
+using namespace sbc;
+
+static void usage() {
+  std::fprintf(stderr,
+    "usage: sbcemu [options] image\n"
+    "       sbcemu [options] --restore FILE [image]\n"
+    "  image is raw binary loaded at 0, or Intel HEX if it has .ihx or .hex extension\n"
+    "  --map FILE        z88dk .map file, run stops at \"cleanup\" (default: image.map if it exists)\n"
+    "  --stop ADDR       run stops when PC reaches ADDR\n"
+    "  --max-cycles N    run stops after N cycles (default 1e12)\n"
+    "  --cpu-hz N        CPU clock (default 3125000)\n"
+    "  --tick-hz N       tick counter clock (default: CPU clock)\n"
+    "  --tx-irq          transmitter raises RST 7 when idle, for CONS_FIFO builds\n"
+    "  --tx-cycles N     transmitter is busy N cycles after OUT\n"
+    "  --output FILE     console output is written to FILE instead of stdout\n"
+    "  --reference       runs instruction by instruction interpreter instead of block engine\n"
+    "  --snapshot FILE   machine state is saved to FILE when run pauses at --snapshot-at or --snapshot-marker\n"
+    "  --snapshot-at X   run pauses when PC reaches address or .map symbol X (e.g. computePi)\n"
+    "  --snapshot-marker N  run pauses right after N-th marker\n"
+    "  --snapshot-only   run stops after snapshot is saved\n"
+    "  --restore FILE    run continues from snapshot, code and read-only data of image (rebuilt program)\n"
+    "                    replace saved ones when image is given\n"
+    "%s", kTimingUsage);
+  std::exit(2);
+}
+
+int main(int argc, char ** argv) {
+  Options options(argc, argv);
+  std::string mapPath, outputPath, image, snapshotPath, snapshotAt, restorePath;
+  uint64_t maxCycles = 1000000000000ULL;
+  Config config;
+  int stopAddr = -1;
+  unsigned snapshotMarker = 0;
+  bool reference = false, snapshotOnly = false;
+  try {
+    while (options.next()) {
+      if (options.is("--map")) {
+        mapPath = options.value();
+      } else if (options.is("--stop")) {
+        stopAddr = options.number() & 0xFFFF;
+      } else if (options.is("--max-cycles")) {
+        maxCycles = options.number();
+      } else if (options.is("--cpu-hz")) {
+        config.cpuHz = options.number();
+      } else if (options.is("--tick-hz")) {
+        config.tickHz = options.number();
+      } else if (options.is("--tx-irq")) {
+        config.txIrq = true;
+      } else if (options.is("--tx-cycles")) {
+        config.txCycles = options.number();
+      } else if (options.is("--output")) {
+        outputPath = options.value();
+      } else if (options.is("--reference")) {
+        reference = true;
+      } else if (options.is("--snapshot")) {
+        snapshotPath = options.value();
+      } else if (options.is("--snapshot-at")) {
+        snapshotAt = options.value();
+      } else if (options.is("--snapshot-marker")) {
+        snapshotMarker = options.number();
+      } else if (options.is("--snapshot-only")) {
+        snapshotOnly = true;
+      } else if (options.is("--restore")) {
+        restorePath = options.value();
+      } else if (options.isPositional() && image.empty()) {
+        image = options.current();
+      } else if (!parseTimingOption(options, config)) {
+        usage();
+      }
+    }
+    if (image.empty() && restorePath.empty()) {
+      usage();
+    }
+    if (snapshotPath.empty() != (snapshotAt.empty() && snapshotMarker == 0)) {
+      throw std::runtime_error("--snapshot needs --snapshot-at or --snapshot-marker and vice versa");
+    }
+
+    if (mapPath.empty() && !image.empty() && std::ifstream(image + ".map")) {
+      mapPath = image + ".map";
+    }
+    MapFile map;
+    if (!mapPath.empty()) {
+      map.load(mapPath);
+      std::vector<std::string> problems = checkLayout(map);
+      if (!problems.empty()) {
+        throw std::runtime_error(mapPath + ": " + problems.front());
+      }
+    }
+    if (stopAddr < 0) {
+      if (const Symbol * cleanup = map.find("cleanup")) {
+        stopAddr = cleanup->value;
+      }
+    }
+    config.stopAddr = stopAddr;
+    config.echo = outputPath.empty();
+
+    // C functions are "_name" in .map file
+    std::string snapshotLabel = "marker " + std::to_string(snapshotMarker);
+    if (!snapshotAt.empty()) {
+      const Symbol * symbol = map.find(snapshotAt);
+      if (symbol == nullptr) {
+        symbol = map.find("_" + snapshotAt);
+      }
+      if (symbol != nullptr) {
+        config.pauseAddr = symbol->value;
+        snapshotLabel = symbol->name;
+      } else {
+        config.pauseAddr = std::stoul(snapshotAt, nullptr, 0) & 0xFFFF;
+        snapshotLabel = snapshotAt;
+      }
+    }
+    config.pauseMarker = snapshotMarker;
+
+    Machine machine(config);
+    if (restorePath.empty()) {
+      machine.load(image);
+    } else {
+      std::string label = loadSnapshot(machine, restorePath);
+      std::fprintf(stderr, "restored %s taken at %s, cycles %llu\n", restorePath.c_str(), label.c_str(),
+        (unsigned long long)machine.cpu.cycles);
+      if (!image.empty()) {
+        for (uint16_t addr : patchCode(machine, image, label)) {
+          std::fprintf(stderr, "warning: return address 0x%04X on stack doesn't follow CALL in %s\n",
+            addr, image.c_str());
+        }
+      }
+      if (config.echo) {
+        std::fwrite(machine.output.data(), 1, machine.output.size(), stdout);
+      }
+    }
+
+    // engine survives pause, so decoded blocks are reused when run continues
+    BlockEngine engine(machine);
+    Stop stop;
+    while (true) {
+      stop = reference ? machine.run(maxCycles) : engine.run(maxCycles);
+      if (stop != Stop::Pause) {
+        break;
+      }
+      saveSnapshot(machine, snapshotPath, snapshotLabel);
+      std::fprintf(stderr, "\nsnapshot %s saved at 0x%04X, cycles %llu\n", snapshotPath.c_str(), machine.cpu.pc,
+        (unsigned long long)machine.cpu.cycles);
+      machine.config.pauseAddr = -1;
+      machine.config.pauseMarker = 0;
+      if (snapshotOnly) {
+        break;
+      }
+    }
+    std::fflush(stdout);
+
+    if (!outputPath.empty()) {
+      std::ofstream out(outputPath, std::ios::binary);
+      out << machine.output;
+    }
+
+    std::fprintf(stderr, "\nstop: %s at 0x%04X\n", stopName(stop), machine.cpu.pc);
+    std::fprintf(stderr, "cycles: %llu (%.6f s at %u Hz)\n",
+      (unsigned long long)machine.cpu.cycles, (double)machine.cpu.cycles / config.cpuHz, config.cpuHz);
+    for (size_t i = 1; i < machine.markers.size(); i++) {
+      uint64_t cycles = machine.markers[i] - machine.markers[i - 1];
+      std::fprintf(stderr, "marker %zu -> %zu: %llu cycles (%.6f s)\n",
+        i, i + 1, (unsigned long long)cycles, (double)cycles / config.cpuHz);
+    }
+    return stop == Stop::CycleLimit ? 1 : 0;
+  } catch (const std::exception & e) {
+    std::fprintf(stderr, "sbcemu: %s\n", e.what());
+    return 2;
+  }
+}
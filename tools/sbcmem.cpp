@@ -0,0 +1,135 @@
+// runs program image of i8080-sbc and prints memory access heatmap and working set of regions
+// for each phase between 0x05 markers
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "machine.h"
+#include "mapfile.h"
+#include "memtrace.h"
+#include "options.h"
+
+using namespace sbc;
+
+static void usage() {
+  std::fprintf(stderr,
+    "usage: sbcmem [options] image\n"
+    "  regions are rom, data, small_F800..small_F8A0 (small_F880 is ticks) and stack of shared/memmap.h\n"
+    "  --map FILE           z88dk .map file, run stops at \"cleanup\" (default: image.map if it exists)\n"
+    "  --slots SIZE:COUNT   adds slot0... regions from start of data region, e.g. 0x1400:10 for pi_chudnovsky\n"
+    "  --region NAME=A-B    adds region of bytes A..B, e.g. memblock=0x43BA-0x4B89\n"
+    "  --symbols            adds static variables from data and bss sections of .map file\n"
+    "  --csv FILE           writes page counts of each phase to FILE\n"
+    "  --max-cycles N       run stops after N cycles (default 1e12)\n"
+    "  --tx-irq             transmitter raises RST 7 when idle, for CONS_FIFO builds\n"
+    "  --output FILE        console output of program is written to FILE\n");
+  std::exit(2);
+}
+
+// "name=start-last"
+static MemTrace::Region parseRegion(const std::string & s) {
+  size_t eq = s.find('=');
+  size_t dash = s.find('-', eq);
+  if (eq == std::string::npos || eq == 0 || dash == std::string::npos) {
+    throw std::runtime_error("bad region " + s);
+  }
+  unsigned long start = std::stoul(s.substr(eq + 1, dash - eq - 1), nullptr, 0);
+  unsigned long last = std::stoul(s.substr(dash + 1), nullptr, 0);
+  if (start > last || last > 0xFFFF) {
+    throw std::runtime_error("bad region " + s);
+  }
+  return { s.substr(0, eq), (uint16_t)start, (uint16_t)last };
+}
+
+int main(int argc, char ** argv) {
+  Options options(argc, argv);
+  std::string mapPath, outputPath, csvPath, image;
+  uint64_t maxCycles = 1000000000000ULL;
+  bool symbols = false;
+  Config config;
+  std::vector<MemTrace::Region> regions = MemTrace::memoryMap();
+  try {
+    while (options.next()) {
+      if (options.is("--map")) {
+        mapPath = options.value();
+      } else if (options.is("--slots")) {
+        std::string s = options.value();
+        size_t colon = s.find(':');
+        if (colon == std::string::npos) {
+          throw std::runtime_error("bad slots " + s);
+        }
+        for (const MemTrace::Region & slot : MemTrace::slots(std::stoul(s.substr(0, colon), nullptr, 0),
+            std::stoul(s.substr(colon + 1), nullptr, 0))) {
+          regions.push_back(slot);
+        }
+      } else if (options.is("--region")) {
+        regions.push_back(parseRegion(options.value()));
+      } else if (options.is("--symbols")) {
+        symbols = true;
+      } else if (options.is("--csv")) {
+        csvPath = options.value();
+      } else if (options.is("--max-cycles")) {
+        maxCycles = options.number();
+      } else if (options.is("--tx-irq")) {
+        config.txIrq = true;
+      } else if (options.is("--output")) {
+        outputPath = options.value();
+      } else if (options.isPositional() && image.empty()) {
+        image = options.current();
+      } else {
+        usage();
+      }
+    }
+    if (image.empty()) {
+      usage();
+    }
+
+    if (mapPath.empty() && std::ifstream(image + ".map")) {
+      mapPath = image + ".map";
+    }
+    if (!mapPath.empty()) {
+      MapFile map;
+      map.load(mapPath);
+      if (const Symbol * cleanup = map.find("cleanup")) {
+        config.stopAddr = cleanup->value;
+      }
+      if (symbols) {
+        for (const MemTrace::Region & variable : MemTrace::dataSymbols(map)) {
+          regions.push_back(variable);
+        }
+      }
+    } else if (symbols) {
+      throw std::runtime_error("--symbols needs .map file");
+    }
+
+    Machine machine(config);
+    machine.load(image);
+    MemTrace trace(machine, regions);
+    Stop stop = machine.run(maxCycles, trace, trace);
+    trace.finish(machine.cpu);
+
+    if (!outputPath.empty()) {
+      std::ofstream out(outputPath, std::ios::binary);
+      out << machine.output;
+    }
+    if (!csvPath.empty()) {
+      FILE * csv = std::fopen(csvPath.c_str(), "w");
+      if (csv == nullptr) {
+        throw std::runtime_error("can't write " + csvPath);
+      }
+      trace.printCsv(csv);
+      std::fclose(csv);
+    }
+
+    std::printf("stop: %s at 0x%04X, %llu cycles\n\n", stopName(stop), machine.cpu.pc,
+      (unsigned long long)machine.cpu.cycles);
+    trace.print(stdout);
+    return stop == Stop::CycleLimit ? 1 : 0;
+  } catch (const std::exception & e) {
+    std::fprintf(stderr, "sbcmem: %s\n", e.what());
+    return 2;
+  }
+}
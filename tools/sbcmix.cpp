@@ -0,0 +1,92 @@
+// runs program images of i8080-sbc and prints dynamic opcode mix: cycle share per opcode class,
+// top opcodes, mnemonics and opcode pairs
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "machine.h"
+#include "opmix.h"
+#include "options.h"
+
+using namespace sbc;
+
+static void usage() {
+  std::fprintf(stderr,
+    "usage: sbcmix [options] image...\n"
+    "  run of each image stops at \"cleanup\" from image.map, with several images cycle share of\n"
+    "  opcode classes of all of them is printed in one table at the end\n"
+    "  --programs DIR    adds every image in DIR/*/ (e.g. programs)\n"
+    "  --top N           rows in opcode, mnemonic and pair tables (default 20)\n"
+    "  --max-cycles N    run of each image stops after N cycles (default 1e12)\n");
+  std::exit(2);
+}
+
+int main(int argc, char ** argv) {
+  Options options(argc, argv);
+  std::vector<std::string> images;
+  uint64_t maxCycles = 1000000000000ULL;
+  size_t top = 20;
+  try {
+    while (options.next()) {
+      if (options.is("--programs")) {
+        for (const std::string & image : findImages(options.value())) {
+          images.push_back(image);
+        }
+      } else if (options.is("--top")) {
+        top = options.number();
+      } else if (options.is("--max-cycles")) {
+        maxCycles = options.number();
+      } else if (options.isPositional()) {
+        images.push_back(options.current());
+      } else {
+        usage();
+      }
+    }
+    if (images.empty()) {
+      usage();
+    }
+
+    std::vector<std::vector<uint64_t>> classCycles;
+    bool limited = false;
+    for (const std::string & image : images) {
+      Machine machine(imageConfig(image));
+      machine.load(image);
+      OpcodeMix mix;
+      Stop stop = machine.run(maxCycles, mix);
+      limited |= stop == Stop::CycleLimit;
+
+      std::printf("%s==== %s, stop: %s at 0x%04X\n", classCycles.empty() ? "" : "\n",
+        image.c_str(), stopName(stop), machine.cpu.pc);
+      mix.print(stdout, top);
+      classCycles.push_back(mix.classCycles());
+    }
+
+    if (images.size() > 1) {
+      std::printf("\ncycle share of opcode classes\n%-16s", "class");
+      for (const std::string & image : images) {
+        std::printf(" %12.12s", std::filesystem::path(image).filename().string().c_str());
+      }
+      std::printf("\n");
+      for (size_t c = 0; c < (size_t)OpClass::Count; c++) {
+        std::printf("%-16s", opClassName((OpClass)c));
+        for (const std::vector<uint64_t> & cycles : classCycles) {
+          uint64_t total = 0;
+          for (uint64_t v : cycles) {
+            total += v;
+          }
+          std::printf(" %11.2f%%", total == 0 ? 0.0 : 100.0 * cycles[c] / total);
+        }
+        std::printf("\n");
+      }
+    }
+    return limited ? 1 : 0;
+  } catch (const std::exception & e) {
+    std::fprintf(stderr, "sbcmix: %s\n", e.what());
+    return 2;
+  }
+}
@@ -0,0 +1,86 @@
+// runs program image of i8080-sbc and prints flat and inclusive cycle profile by .map symbols
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "machine.h"
+#include "mapfile.h"
+#include "options.h"
+#include "profiler.h"
+
+using namespace sbc;
+
+static void usage() {
+  std::fprintf(stderr,
+    "usage: sbcprof [options] image\n"
+    "  --map FILE        z88dk .map file (default: image.map)\n"
+    "  --top N           functions in each table (default 30)\n"
+    "  --labels          every code label is a separate function\n"
+    "  --max-cycles N    run stops after N cycles (default 1e12)\n"
+    "  --tx-irq          transmitter raises RST 7 when idle, for CONS_FIFO builds\n"
+    "  --output FILE     console output of program is written to FILE\n");
+  std::exit(2);
+}
+
+int main(int argc, char ** argv) {
+  Options options(argc, argv);
+  std::string mapPath, outputPath, image;
+  uint64_t maxCycles = 1000000000000ULL;
+  size_t top = 30;
+  bool allLabels = false;
+  Config config;
+  try {
+    while (options.next()) {
+      if (options.is("--map")) {
+        mapPath = options.value();
+      } else if (options.is("--top")) {
+        top = options.number();
+      } else if (options.is("--labels")) {
+        allLabels = true;
+      } else if (options.is("--max-cycles")) {
+        maxCycles = options.number();
+      } else if (options.is("--tx-irq")) {
+        config.txIrq = true;
+      } else if (options.is("--output")) {
+        outputPath = options.value();
+      } else if (options.isPositional() && image.empty()) {
+        image = options.current();
+      } else {
+        usage();
+      }
+    }
+    if (image.empty()) {
+      usage();
+    }
+    if (mapPath.empty()) {
+      mapPath = image + ".map";
+    }
+
+    MapFile map;
+    map.load(mapPath);
+    if (const Symbol * cleanup = map.find("cleanup")) {
+      config.stopAddr = cleanup->value;
+    }
+
+    Machine machine(config);
+    machine.load(image);
+    Profiler profiler(map, allLabels);
+    Stop stop = machine.run(maxCycles, profiler);
+    profiler.finish(machine.cpu);
+
+    if (!outputPath.empty()) {
+      std::ofstream out(outputPath, std::ios::binary);
+      out << machine.output;
+    }
+
+    std::printf("stop: %s at 0x%04X\n", stopName(stop), machine.cpu.pc);
+    profiler.print(stdout, machine.cpu.cycles, top);
+    return stop == Stop::CycleLimit ? 1 : 0;
+  } catch (const std::exception & e) {
+    std::fprintf(stderr, "sbcprof: %s\n", e.what());
+    return 2;
+  }
+}
@@ -0,0 +1,253 @@
+// builds variants of a program over parameter matrix (-D macros, optimization flags) with zcc,
+// runs them on all host cores, each in its own emulator, and prints ticks of all of them
+// with best configuration
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "options.h"
+#include "sweep.h"
+
+using namespace sbc;
+
+static void usage() {
+  std::fprintf(stderr,
+    "usage: sbcsweep [options] [image...]\n"
+    "  builds every combination of --set values of one build.bat line and runs them in parallel,\n"
+    "  images given as arguments are run as they are, without build\n"
+    "  --program DIR     program folder with build.bat (e.g. programs/pi_chudnovsky)\n"
+    "  --target NAME     build.bat line with \"-o NAME\" (default: first zcc line)\n"
+    "  --set SPEC        matrix axis, repeatable: NAME=V1,V2,... sets -DNAME, -O2,-O3,-SO3 replaces\n"
+    "                    optimization flag\n"
+    "  --work DIR        folder variants are built in (default: sbcsweep in temp folder)\n"
+    "  --jobs N          parallel builds and runs (default: host cores)\n"
+    "  --metric NAME     metric best configuration is chosen by, lowest wins (default cycles)\n"
+    "  --all             prints all metrics of each variant, not only cycles and --metric\n"
+    "  --csv FILE        writes \"variant,metric,value\" lines of all metrics\n"
+    "  --max-cycles N    run of each image stops after N cycles (default 1e12)\n"
+    "  --dry-run         only prints build commands\n");
+  std::exit(2);
+}
+
+struct Job {
+  std::string label;
+  std::vector<std::string> values;
+  // empty for images run as they are
+  std::string command;
+  std::string image;
+  std::string status;
+  RunResult result;
+
+  const Metric * metric(const std::string & name) const {
+    for (const Metric & m : result.metrics) {
+      if (m.name == name) {
+        return &m;
+      }
+    }
+    return nullptr;
+  }
+};
+
+// build (if needed) and run of one job, build output goes to image.log
+static void runJob(Job & job, const std::string & programDir, uint64_t maxCycles) {
+  if (!job.command.empty()) {
+    std::string shell = "cd \"" + programDir + "\" && " + job.command + " > \"" + job.image + ".log\" 2>&1";
+    if (std::system(shell.c_str()) != 0) {
+      job.status = "build failed, see " + job.image + ".log";
+      return;
+    }
+  }
+  job.result = runImage(job.image, maxCycles);
+  job.status = job.result.stop == Stop::CycleLimit ? "cycle limit" : "ok";
+}
+
+static std::string valueText(const Metric * metric) {
+  return metric == nullptr ? "-" : std::to_string(metric->value);
+}
+
+int main(int argc, char ** argv) {
+  Options options(argc, argv);
+  std::string programDir, target, csvPath, metricName = "cycles";
+  std::string work = (std::filesystem::temp_directory_path() / "sbcsweep").string();
+  std::vector<Axis> axes;
+  std::vector<std::string> images;
+  unsigned jobsCount = std::max(1u, std::thread::hardware_concurrency());
+  uint64_t maxCycles = 1000000000000ULL;
+  bool all = false, dryRun = false;
+  try {
+    while (options.next()) {
+      if (options.is("--program")) {
+        programDir = options.value();
+      } else if (options.is("--target")) {
+        target = options.value();
+      } else if (options.is("--set")) {
+        axes.push_back(parseAxis(options.value()));
+      } else if (options.is("--work")) {
+        work = options.value();
+      } else if (options.is("--jobs")) {
+        jobsCount = std::max<uint64_t>(1, options.number());
+      } else if (options.is("--metric")) {
+        metricName = options.value();
+      } else if (options.is("--all")) {
+        all = true;
+      } else if (options.is("--csv")) {
+        csvPath = options.value();
+      } else if (options.is("--max-cycles")) {
+        maxCycles = options.number();
+      } else if (options.is("--dry-run")) {
+        dryRun = true;
+      } else if (options.isPositional()) {
+        images.push_back(options.current());
+      } else {
+        usage();
+      }
+    }
+    if (programDir.empty() && images.empty()) {
+      usage();
+    }
+
+    std::vector<Job> jobs;
+    if (!programDir.empty()) {
+      std::string command;
+      for (const std::string & line : buildCommands(programDir + "/build.bat")) {
+        if (command.empty() && (target.empty() || outputName(line) == target)) {
+          command = line;
+        }
+      }
+      if (command.empty()) {
+        throw std::runtime_error("no zcc line " + (target.empty() ? "" : "with -o " + target + " ") +
+          "in " + programDir + "/build.bat");
+      }
+      std::filesystem::create_directories(work);
+      std::string base = target.empty() ? outputName(command) : target;
+      std::string workDir = std::filesystem::absolute(work).string();
+      for (const Variant & variant : expandMatrix(command, axes, workDir, base)) {
+        jobs.push_back({ variant.label.empty() ? base : variant.label, variant.values, variant.command, variant.image });
+      }
+    }
+    for (const std::string & image : images) {
+      jobs.push_back({ std::filesystem::path(image).filename().string(), { }, "", image });
+    }
+
+    if (dryRun) {
+      for (const Job & job : jobs) {
+        std::printf("%s\n  %s\n", job.label.c_str(), job.command.empty() ? job.image.c_str() : job.command.c_str());
+      }
+      return 0;
+    }
+
+    // workers take jobs in order, each run has its own Machine
+    std::atomic<size_t> next(0);
+    std::mutex logMutex;
+    auto worker = [&]() {
+      for (size_t i; (i = next++) < jobs.size(); ) {
+        {
+          std::lock_guard<std::mutex> lock(logMutex);
+          std::fprintf(stderr, "[%zu/%zu] %s\n", i + 1, jobs.size(), jobs[i].label.c_str());
+        }
+        try {
+          runJob(jobs[i], programDir, maxCycles);
+        } catch (const std::exception & e) {
+          jobs[i].status = e.what();
+        }
+      }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < std::min<size_t>(jobsCount, jobs.size()); i++) {
+      threads.emplace_back(worker);
+    }
+    for (std::thread & thread : threads) {
+      thread.join();
+    }
+
+    // lowest value of metric among finished runs
+    const Job * best = nullptr;
+    for (const Job & job : jobs) {
+      const Metric * m = job.metric(metricName);
+      if (job.status == "ok" && m != nullptr && (best == nullptr || m->value < best->metric(metricName)->value)) {
+        best = &job;
+      }
+    }
+
+    size_t labelWidth = 7;
+    for (const Job & job : jobs) {
+      labelWidth = std::max(labelWidth, job.label.size());
+    }
+    std::printf("%-*s %16s %16s %9s  %s\n", (int)labelWidth, "variant", "cycles",
+      metricName == "cycles" ? "" : metricName.c_str(), "vs best", "status");
+    for (const Job & job : jobs) {
+      const Metric * m = job.metric(metricName);
+      std::string change = "-";
+      if (best != nullptr && m != nullptr) {
+        char buf[32];
+        uint64_t bestValue = best->metric(metricName)->value;
+        std::snprintf(buf, sizeof(buf), "%+.2f%%", bestValue == 0 ? 0.0 : 100.0 * ((double)m->value - bestValue) / bestValue);
+        change = buf;
+      }
+      std::printf("%-*s %16s %16s %9s  %s\n", (int)labelWidth, job.label.c_str(), valueText(job.metric("cycles")).c_str(),
+        metricName == "cycles" ? "" : valueText(m).c_str(), change.c_str(), job.status.c_str());
+      if (all) {
+        for (const Metric & metric : job.result.metrics) {
+          std::printf("    %-40s %16llu\n", metric.name.c_str(), (unsigned long long)metric.value);
+        }
+      }
+    }
+
+    if (best == nullptr) {
+      std::printf("\nno finished run has metric \"%s\"\n", metricName.c_str());
+    } else {
+      std::printf("\nbest by %s: %s (%llu)\n", metricName.c_str(), best->label.c_str(),
+        (unsigned long long)best->metric(metricName)->value);
+      // lowest metric reached with each value of each axis, shows how much each parameter matters
+      for (size_t a = 0; a < axes.size(); a++) {
+        std::printf("  %s:", axes[a].name.empty() ? "flags" : axes[a].name.c_str());
+        for (const std::string & value : axes[a].values) {
+          const Metric * lowest = nullptr;
+          for (const Job & job : jobs) {
+            const Metric * m = job.metric(metricName);
+            if (job.status == "ok" && m != nullptr && job.values.size() == axes.size() && job.values[a] == value
+                && (lowest == nullptr || m->value < lowest->value)) {
+              lowest = m;
+            }
+          }
+          std::printf("  %s %s", value.c_str(), valueText(lowest).c_str());
+        }
+        std::printf("\n");
+      }
+    }
+
+    if (!csvPath.empty()) {
+      std::ofstream out(csvPath);
+      if (!out) {
+        throw std::runtime_error("can't write " + csvPath);
+      }
+      out << "variant,metric,value\n";
+      for (const Job & job : jobs) {
+        for (const Metric & metric : job.result.metrics) {
+          out << job.label << "," << metric.name << "," << metric.value << "\n";
+        }
+      }
+    }
+
+    for (const Job & job : jobs) {
+      if (job.status != "ok") {
+        return 1;
+      }
+    }
+    return 0;
+  } catch (const std::exception & e) {
+    std::fprintf(stderr, "sbcsweep: %s\n", e.what());
+    return 2;
+  }
+}
@@ -0,0 +1,139 @@
+#include "snapshot.h"
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+#include "mapfile.h"
+
+namespace sbc {
+
+static const char kMagic[8] = { 'S', 'B', 'C', 'S', 'N', 'A', 'P', '1' };
+
+// little-endian fields
+static void put(std::ostream & out, uint64_t v, unsigned size) {
+  for (unsigned i = 0; i < size; i++) {
+    out.put((char)(v >> (i * 8)));
+  }
+}
+
+static void putString(std::ostream & out, const std::string & s) {
+  put(out, s.size(), 4);
+  out.write(s.data(), s.size());
+}
+
+static uint64_t get(std::istream & in, unsigned size) {
+  uint64_t v = 0;
+  for (unsigned i = 0; i < size; i++) {
+    v |= (uint64_t)(uint8_t)in.get() << (i * 8);
+  }
+  return v;
+}
+
+static std::string getString(std::istream & in) {
+  std::string s(get(in, 4), '\0');
+  in.read(&s[0], s.size());
+  return s;
+}
+
+void saveSnapshot(const Machine & machine, const std::string & path, const std::string & label) {
+  std::ofstream out(path, std::ios::binary);
+  if (!out) {
+    throw std::runtime_error("can't write " + path);
+  }
+  const Cpu & cpu = machine.cpu;
+  out.write(kMagic, sizeof(kMagic));
+  putString(out, label);
+  for (uint8_t r : { cpu.a, cpu.b, cpu.c, cpu.d, cpu.e, cpu.h, cpu.l, cpu.psw() }) {
+    put(out, r, 1);
+  }
+  put(out, cpu.pc, 2);
+  put(out, cpu.sp, 2);
+  put(out, cpu.inte | (cpu.eiDelay << 1) | (cpu.halted << 2) | (machine.txUsed << 3), 1);
+  put(out, cpu.cycles, 8);
+  put(out, machine.ticks(), 8);
+  put(out, machine.txReadyAt, 8);
+  out.write((const char *)machine.mem, sizeof(machine.mem));
+  putString(out, machine.output);
+  put(out, machine.markers.size(), 4);
+  for (uint64_t marker : machine.markers) {
+    put(out, marker, 8);
+  }
+  if (!out) {
+    throw std::runtime_error("can't write " + path);
+  }
+}
+
+std::string loadSnapshot(Machine & machine, const std::string & path) {
+  std::ifstream in(path, std::ios::binary);
+  char magic[sizeof(kMagic)] = { };
+  if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), kMagic)) {
+    throw std::runtime_error(path + " isn't a snapshot");
+  }
+  Cpu & cpu = machine.cpu;
+  std::string label = getString(in);
+  cpu.a = get(in, 1);
+  cpu.b = get(in, 1);
+  cpu.c = get(in, 1);
+  cpu.d = get(in, 1);
+  cpu.e = get(in, 1);
+  cpu.h = get(in, 1);
+  cpu.l = get(in, 1);
+  cpu.setPsw(get(in, 1));
+  cpu.pc = get(in, 2);
+  cpu.sp = get(in, 2);
+  uint8_t bits = get(in, 1);
+  cpu.inte = bits & 1;
+  cpu.eiDelay = bits & 2;
+  cpu.halted = bits & 4;
+  machine.txUsed = bits & 8;
+  cpu.cycles = get(in, 8);
+  uint64_t ticks = get(in, 8);
+  machine.txReadyAt = get(in, 8);
+  in.read((char *)machine.mem, sizeof(machine.mem));
+  machine.output = getString(in);
+  machine.markers.resize(get(in, 4));
+  for (uint64_t & marker : machine.markers) {
+    marker = get(in, 8);
+  }
+  if (!in) {
+    throw std::runtime_error("truncated snapshot " + path);
+  }
+  if (machine.ticks() != ticks) {
+    throw std::runtime_error("tick counter of " + path + " doesn't match clocks of this run");
+  }
+  return label;
+}
+
+static bool isCall(uint8_t opcode) {
+  return opcode == 0xCD || (opcode & 0xC7) == 0xC4;
+}
+
+std::vector<uint16_t> patchCode(Machine & machine, const std::string & image, const std::string & label) {
+  MapFile map;
+  map.load(image + ".map");
+  const Symbol * dataHead = map.find("__DATA_head");
+  if (dataHead == nullptr) {
+    throw std::runtime_error("no __DATA_head in " + image + ".map");
+  }
+  std::unique_ptr<Machine> patched(new Machine());
+  patched->load(image);
+
+  // return addresses are words on stack that follow CALL in old code
+  std::vector<uint16_t> broken;
+  for (uint32_t addr = machine.cpu.sp; addr >= MEM_STACK_LIMIT && addr + 1 <= 0xFFFF; addr += 2) {
+    uint16_t ret = machine.mem[addr] | (machine.mem[addr + 1] << 8);
+    if (ret >= 3 && ret < dataHead->value && isCall(machine.mem[ret - 3]) && !isCall(patched->mem[ret - 3])) {
+      broken.push_back(ret);
+    }
+  }
+
+  std::copy(patched->mem, patched->mem + dataHead->value, machine.mem);
+  if (const Symbol * at = map.find(label)) {
+    machine.cpu.pc = at->value;
+  }
+  return broken;
+}
+
+}
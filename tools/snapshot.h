@@ -0,0 +1,30 @@
+#ifndef __SBC_SNAPSHOT_H__
+#define __SBC_SNAPSHOT_H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "machine.h"
+
+namespace sbc {
+
+// full machine state in a file: registers, cycles (tick counter follows them), 64Kb of memory, transmitter
+// state, console output and markers so far; label tells where it was taken, e.g. "_computePi" or "marker 3"
+//
+// both throw std::runtime_error if file can't be written or read, loadSnapshot() also when tick counter
+// of machine config wouldn't match the saved one (other --tick-hz or --cpu-hz)
+void saveSnapshot(const Machine & machine, const std::string & path, const std::string & label);
+std::string loadSnapshot(Machine & machine, const std::string & path);
+
+// code and read-only data of image (0 .. __DATA_head of image.map) replace ones in memory, data and BSS
+// stay as they are, so a snapshot continues with patched build; when label is a symbol of image.map,
+// PC is moved to its new address; throws std::runtime_error if image or its .map can't be read
+//
+// returns return addresses on stack that don't follow CALL in patched code any more, run won't come
+// back correctly to such frames, so callers of snapshot point should keep their addresses
+std::vector<uint16_t> patchCode(Machine & machine, const std::string & image, const std::string & label);
+
+}
+
+#endif
@@ -0,0 +1,102 @@
+#include "sweep.h"
+
+#include <sstream>
+#include <stdexcept>
+
+namespace sbc {
+
+static std::vector<std::string> split(const std::string & s, char separator) {
+  std::vector<std::string> parts;
+  std::istringstream in(s);
+  std::string part;
+  while (std::getline(in, part, separator)) {
+    if (!part.empty()) {
+      parts.push_back(part);
+    }
+  }
+  return parts;
+}
+
+static bool isOptimizationFlag(const std::string & token) {
+  return token.compare(0, 2, "-O") == 0 || token.compare(0, 3, "-SO") == 0;
+}
+
+Axis parseAxis(const std::string & spec) {
+  Axis axis;
+  std::string values = spec;
+  if (spec.empty() || spec[0] != '-') {
+    size_t eq = spec.find('=');
+    if (eq == std::string::npos || eq == 0) {
+      throw std::runtime_error("bad axis " + spec + ", expected NAME=V1,V2 or -O2,-O3");
+    }
+    axis.name = spec.substr(0, eq);
+    values = spec.substr(eq + 1);
+  }
+  axis.values = split(values, ',');
+  if (axis.values.empty()) {
+    throw std::runtime_error("axis " + spec + " has no values");
+  }
+  for (const std::string & value : axis.values) {
+    if (axis.name.empty() && !isOptimizationFlag(value)) {
+      throw std::runtime_error("bad flag " + value + ", expected -O or -SO option");
+    }
+  }
+  return axis;
+}
+
+std::string applyValues(const std::string & command, const std::vector<Axis> & axes,
+    const std::vector<std::string> & values, const std::string & output) {
+  std::vector<std::string> tokens = split(command, ' ');
+  std::string result;
+  for (size_t i = 0; i < tokens.size(); i++) {
+    const std::string & token = tokens[i];
+    if (token == "-o") {
+      i++;
+      continue;
+    }
+    bool replaced = false;
+    for (const Axis & axis : axes) {
+      if (axis.name.empty()) {
+        replaced |= isOptimizationFlag(token);
+      } else {
+        std::string define = "-D" + axis.name;
+        replaced |= token == define || token.compare(0, define.size() + 1, define + "=") == 0;
+      }
+    }
+    if (!replaced) {
+      result += (result.empty() ? "" : " ") + token;
+    }
+  }
+  for (size_t i = 0; i < axes.size(); i++) {
+    result += axes[i].name.empty() ? " " + values[i] : " -D" + axes[i].name + "=" + values[i];
+  }
+  return result + " -o " + output;
+}
+
+std::vector<Variant> expandMatrix(const std::string & command, const std::vector<Axis> & axes,
+    const std::string & outputDir, const std::string & base) {
+  std::vector<Variant> variants;
+  // odometer over value indexes
+  std::vector<size_t> index(axes.size(), 0);
+  while (true) {
+    Variant variant;
+    for (size_t i = 0; i < axes.size(); i++) {
+      const std::string & value = axes[i].values[index[i]];
+      variant.values.push_back(value);
+      variant.label += (i == 0 ? "" : " ") + (axes[i].name.empty() ? value : axes[i].name + "=" + value);
+    }
+    variant.image = outputDir + "/" + base + "_" + std::to_string(variants.size() + 1);
+    variant.command = applyValues(command, axes, variant.values, variant.image);
+    variants.push_back(variant);
+
+    size_t i = axes.size();
+    while (i > 0 && ++index[i - 1] == axes[i - 1].values.size()) {
+      index[--i] = 0;
+    }
+    if (i == 0) {
+      return variants;
+    }
+  }
+}
+
+}
@@ -0,0 +1,41 @@
+#ifndef __SBC_SWEEP_H__
+#define __SBC_SWEEP_H__
+
+#include <string>
+#include <vector>
+
+namespace sbc {
+
+// one dimension of parameter matrix: macro set with -DNAME=VALUE, or optimization flag
+// (-O2, -O3, -SO3...) when name is empty
+struct Axis {
+  std::string name;
+  std::vector<std::string> values;
+};
+
+// "NAME=V1,V2,..." gives macro axis, "-O2,-O3,-SO3" gives flag axis,
+// throws std::runtime_error on malformed spec
+Axis parseAxis(const std::string & spec);
+
+// one point of matrix, values[i] is value of axes[i]
+struct Variant {
+  std::vector<std::string> values;
+  // "N=100 KARATSUBA_THRESHOLD_MUL=20 -O3"
+  std::string label;
+  std::string command;
+  std::string image;
+};
+
+// zcc command with values applied: -DNAME options of macro axes and -O/-SO options (for flag axis)
+// are replaced or added, "-o" is set to output
+std::string applyValues(const std::string & command, const std::vector<Axis> & axes,
+  const std::vector<std::string> & values, const std::string & output);
+
+// every combination of axis values, last axis changes fastest; images are named
+// outputDir/base_1, outputDir/base_2...
+std::vector<Variant> expandMatrix(const std::string & command, const std::vector<Axis> & axes,
+  const std::string & outputDir, const std::string & base);
+
+}
+
+#endif
@@ -0,0 +1,256 @@
+#include "timing.h"
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+namespace sbc {
+
+// probes are few hundred cycles long
+static const uint64_t kProbeCycles = 100000;
+
+// larger values would overflow cycles of decoded instruction in block engine
+static const unsigned kMaxWait = 64;
+
+const char * const kTimingUsage =
+  "  --rom-wait N      wait states of every access below --rom-end (default 0)\n"
+  "  --ram-wait N      wait states of every other memory access (default 0)\n"
+  "  --ticks-wait N    wait states of every tick counter access (default 0)\n"
+  "  --out-wait P:N    OUT to port P takes N more cycles, repeatable (default 0)\n"
+  "  --tick-offset N   tick counter value when CPU starts (default 0)\n"
+  "  --rom-end ADDR    end of ROM image region (default 0x3000)\n";
+
+static unsigned waitValue(Options & options) {
+  uint64_t v = options.number();
+  if (v > kMaxWait) {
+    throw std::runtime_error("wait states above " + std::to_string(kMaxWait) + " aren't supported");
+  }
+  return v;
+}
+
+bool parseTimingOption(Options & options, Config & config) {
+  if (options.is("--rom-wait")) {
+    config.romWait = waitValue(options);
+  } else if (options.is("--ram-wait")) {
+    config.ramWait = waitValue(options);
+  } else if (options.is("--ticks-wait")) {
+    config.ticksWait = waitValue(options);
+  } else if (options.is("--out-wait")) {
+    std::string spec = options.value();
+    size_t colon = spec.find(':');
+    size_t portUsed = 0, cyclesUsed = 0;
+    unsigned long port = 0, cycles = 0;
+    try {
+      port = std::stoul(spec.substr(0, colon), &portUsed, 0);
+      cycles = std::stoul(spec.substr(colon + 1), &cyclesUsed, 0);
+    } catch (const std::exception &) {
+      colon = std::string::npos;
+    }
+    if (colon == std::string::npos || portUsed != colon || cyclesUsed != spec.size() - colon - 1
+        || port > 0xFF || cycles > 0xFF) {
+      throw std::runtime_error("bad --out-wait " + spec + ", expected PORT:CYCLES");
+    }
+    config.outWait[port] = cycles;
+  } else if (options.is("--tick-offset")) {
+    config.tickOffset = options.number();
+  } else if (options.is("--rom-end")) {
+    config.romEnd = options.number();
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::string timingOptions(const Config & config) {
+  Config defaults;
+  std::string s;
+  auto add = [&](const std::string & option) {
+    s += (s.empty() ? "" : " ") + option;
+  };
+  if (config.romEnd != defaults.romEnd) {
+    add("--rom-end " + std::to_string(config.romEnd));
+  }
+  if (config.romWait != defaults.romWait) {
+    add("--rom-wait " + std::to_string(config.romWait));
+  }
+  if (config.ramWait != defaults.ramWait) {
+    add("--ram-wait " + std::to_string(config.ramWait));
+  }
+  if (config.ticksWait != defaults.ticksWait) {
+    add("--ticks-wait " + std::to_string(config.ticksWait));
+  }
+  for (unsigned port = 0; port < config.outWait.size(); port++) {
+    if (config.outWait[port] != 0) {
+      add("--out-wait " + std::to_string(port) + ":" + std::to_string(config.outWait[port]));
+    }
+  }
+  if (config.tickOffset != defaults.tickOffset) {
+    add("--tick-offset " + std::to_string(config.tickOffset));
+  }
+  return s;
+}
+
+// LXI SP,0 (8080 doesn't reset SP), setup, LDA [0xF880], MOV B,A, body, LDA [0xF880], SUB B, OUT 1,
+// HLT, then tail (subroutines called by body)
+static Probe deltaProbe(const std::string & name, const std::string & description,
+    const std::vector<uint8_t> & setup, const std::vector<uint8_t> & body, const std::vector<uint8_t> & tail = { }) {
+  static const std::vector<uint8_t> start = { 0x31, 0x00, 0x00 };
+  static const std::vector<uint8_t> firstRead = { 0x3A, 0x80, 0xF8, 0x47 };
+  static const std::vector<uint8_t> secondRead = { 0x3A, 0x80, 0xF8, 0x90, 0xD3, kConsolePort, 0x76 };
+  Probe probe { name, description };
+  for (const std::vector<uint8_t> * part : { &start, &setup, &firstRead, &body, &secondRead, &tail }) {
+    for (uint8_t byte : *part) {
+      probe.image.push_back(byte);
+    }
+  }
+  return probe;
+}
+
+std::vector<Probe> timingProbes() {
+  std::vector<Probe> probes;
+
+  // same as programs/clocks with 1..3 NOPs, each NOP should add 4 cycles
+  for (unsigned nops = 1; nops <= 3; nops++) {
+    Probe probe { "clocks_" + std::to_string(nops), "tick counter low byte after " + std::to_string(nops) + " NOPs" };
+    probe.image.assign(nops, 0x00);
+    probe.image.insert(probe.image.end(), { 0x3A, 0x80, 0xF8, 0xD3, kConsolePort, 0x76 });
+    probe.absolute = true;
+    probes.push_back(probe);
+  }
+
+  uint8_t ramLo = kRomEnd & 0xFF, ramHi = kRomEnd >> 8;
+  probes.push_back(deltaProbe("delta_empty", "ticks between two counter reads", { }, { }));
+  probes.push_back(deltaProbe("delta_nop", "same with 4 NOPs between reads", { }, { 0x00, 0x00, 0x00, 0x00 }));
+  probes.push_back(deltaProbe("delta_rom_read", "same with LDA [0x0000]", { }, { 0x3A, 0x00, 0x00 }));
+  probes.push_back(deltaProbe("delta_rom_write", "same with STA [0x1000]", { }, { 0x32, 0x00, 0x10 }));
+  probes.push_back(deltaProbe("delta_ram_read", "same with LDA [0x3000]", { }, { 0x3A, ramLo, ramHi }));
+  probes.push_back(deltaProbe("delta_ram_write", "same with STA [0x3000]", { }, { 0x32, ramLo, ramHi }));
+  probes.push_back(deltaProbe("delta_ticks_read", "same with LDA [0xF884]", { }, { 0x3A, 0x84, 0xF8 }));
+  probes.push_back(deltaProbe("delta_out", "same with MVI A,'.' and OUT 1, prints '.' first", { },
+    { 0x3E, '.', 0xD3, kConsolePort }));
+
+  // 4 NOPs and RET, called in ROM right after HLT of probe (3 + 4 + 3 + 7 bytes) and copied to RAM
+  std::vector<uint8_t> sub = { 0x00, 0x00, 0x00, 0x00, 0xC9 };
+  probes.push_back(deltaProbe("delta_rom_call", "same with CALL of 4 NOPs and RET in ROM", { },
+    { 0xCD, 17, 0x00 }, sub));
+  std::vector<uint8_t> copy;
+  for (unsigned i = 0; i < sub.size(); i++) {
+    copy.insert(copy.end(), { 0x3E, sub[i], 0x32, (uint8_t)(ramLo + i), ramHi });
+  }
+  probes.push_back(deltaProbe("delta_ram_call", "same with CALL of 4 NOPs and RET in RAM", copy,
+    { 0xCD, ramLo, ramHi }));
+  return probes;
+}
+
+std::string runProbe(const std::vector<uint8_t> & image, const Config & config) {
+  if (image.size() > 0x10000) {
+    throw std::runtime_error("probe doesn't fit 64Kb");
+  }
+  Config probeConfig = config;
+  probeConfig.stopAddr = -1;
+  probeConfig.pauseAddr = -1;
+  probeConfig.pauseMarker = 0;
+  probeConfig.echo = false;
+  std::unique_ptr<Machine> machine(new Machine(probeConfig));
+  std::copy(image.begin(), image.end(), machine->mem);
+  machine->run(kProbeCycles);
+  return machine->output;
+}
+
+std::vector<Measurement> loadMeasurements(const std::string & path) {
+  std::ifstream in(path);
+  if (!in) {
+    throw std::runtime_error("can't open " + path);
+  }
+  std::vector<Measurement> measured;
+  std::string line;
+  for (unsigned lineNo = 1; std::getline(in, line); lineNo++) {
+    std::istringstream fields(line.substr(0, line.find('#')));
+    Measurement m;
+    if (!(fields >> m.probe)) {
+      continue;
+    }
+    for (std::string byte; fields >> byte; ) {
+      size_t used = 0;
+      unsigned long v = 0;
+      try {
+        v = std::stoul(byte, &used, 0);
+      } catch (const std::exception &) {
+        used = 0;
+      }
+      if (used != byte.size() || v > 0xFF) {
+        throw std::runtime_error(path + ":" + std::to_string(lineNo) + ": bad byte " + byte);
+      }
+      m.output.push_back((char)v);
+    }
+    measured.push_back(m);
+  }
+  return measured;
+}
+
+// differing bytes, missing and extra ones count too
+static unsigned mismatchedBytes(const std::string & a, const std::string & b) {
+  unsigned n = std::max(a.size(), b.size()) - std::min(a.size(), b.size());
+  for (size_t i = 0; i < std::min(a.size(), b.size()); i++) {
+    n += a[i] != b[i];
+  }
+  return n;
+}
+
+TimingFit fitTiming(const std::vector<Probe> & probes, const std::vector<Measurement> & measured,
+    const Config & base, unsigned maxWait, unsigned maxOutWait) {
+  std::vector<std::pair<const Probe *, const Measurement *>> pairs;
+  std::pair<const Probe *, const Measurement *> anchor(nullptr, nullptr);
+  for (const Measurement & m : measured) {
+    auto probe = std::find_if(probes.begin(), probes.end(), [&](const Probe & p) { return p.name == m.probe; });
+    if (probe == probes.end()) {
+      throw std::runtime_error("unknown probe " + m.probe);
+    }
+    pairs.push_back({ &*probe, &m });
+    if (anchor.first == nullptr && probe->absolute && !m.output.empty()) {
+      anchor = pairs.back();
+    }
+  }
+
+  TimingFit best;
+  unsigned bestWaits = 0;
+  bool found = false;
+  maxWait = std::min(maxWait, kMaxWait);
+  maxOutWait = std::min(maxOutWait, 0xFFu);
+  for (unsigned romWait = 0; romWait <= maxWait; romWait++) {
+    for (unsigned ramWait = 0; ramWait <= maxWait; ramWait++) {
+      for (unsigned ticksWait = 0; ticksWait <= maxWait; ticksWait++) {
+        for (unsigned outWait = 0; outWait <= maxOutWait; outWait++) {
+          Config config = base;
+          config.romWait = romWait;
+          config.ramWait = ramWait;
+          config.ticksWait = ticksWait;
+          config.outWait[kConsolePort] = outWait;
+          // offset only shifts the counter byte that absolute probe prints
+          if (anchor.first != nullptr) {
+            config.tickOffset = 0;
+            std::string output = runProbe(anchor.first->image, config);
+            if (!output.empty()) {
+              config.tickOffset = (uint8_t)(anchor.second->output[0] - output[0]);
+            }
+          }
+          unsigned mismatches = 0;
+          for (const auto & pair : pairs) {
+            mismatches += mismatchedBytes(runProbe(pair.first->image, config), pair.second->output);
+          }
+          unsigned waits = romWait + ramWait + ticksWait + outWait;
+          if (!found || mismatches < best.mismatches || (mismatches == best.mismatches && waits < bestWaits)) {
+            best = { config, mismatches };
+            bestWaits = waits;
+            found = true;
+          }
+        }
+      }
+    }
+  }
+  return best;
+}
+
+}
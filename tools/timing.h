@@ -0,0 +1,62 @@
+#ifndef __SBC_TIMING_H__
+#define __SBC_TIMING_H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "machine.h"
+#include "options.h"
+
+namespace sbc {
+
+// options that set timing fields of Config, shared by sbcemu and sbccal
+extern const char * const kTimingUsage;
+
+// handles current option if it is one of kTimingUsage, returns false otherwise
+bool parseTimingOption(Options & options, Config & config);
+
+// same values as options, e.g. "--rom-wait 1 --out-wait 1:3", default ones are skipped
+std::string timingOptions(const Config & config);
+
+// micro-program run on the board and in emulator, its console output shows board timing
+struct Probe {
+  std::string name;
+  std::string description;
+  std::vector<uint8_t> image;
+  // output has raw tick counter byte, so it depends on config.tickOffset
+  bool absolute = false;
+};
+
+// generated probes: tick counter is read twice around a body (NOPs, read or write of ROM, RAM,
+// counter, OUT to console port, code run from RAM) and difference of low bytes is sent to port 1
+std::vector<Probe> timingProbes();
+
+// console output of probe image run by Machine::run() with config, stops at HLT
+std::string runProbe(const std::vector<uint8_t> & image, const Config & config);
+
+// output of one probe read from the board
+struct Measurement {
+  std::string probe;
+  std::string output;
+};
+
+// lines "name byte byte ...", bytes are numbers like 26 or 0x1A, '#' starts comment;
+// throws std::runtime_error if file can't be read or line is malformed
+std::vector<Measurement> loadMeasurements(const std::string & path);
+
+struct TimingFit {
+  Config config;
+  // output bytes of measured probes that fitted config doesn't reproduce
+  unsigned mismatches = 0;
+};
+
+// tries ROM, RAM and counter wait states 0..maxWait, console OUT latency 0..maxOutWait with tick
+// offset taken from the first absolute probe, other fields come from base; fewest mismatches win,
+// then fewest wait states; throws std::runtime_error when measurement names unknown probe
+TimingFit fitTiming(const std::vector<Probe> & probes, const std::vector<Measurement> & measured,
+  const Config & base, unsigned maxWait, unsigned maxOutWait);
+
+}
+
+#endif